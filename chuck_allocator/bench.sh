@@ -0,0 +1,8 @@
+#!/bin/bash
+
+set -e
+
+g++ -std=c++17 -O2 -pthread -I./ bench/bench.cpp -o bench_run
+./bench_run
+
+rm bench_run
@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory_resource>
+#include <random>
+#include <thread>
+#include <vector>
+#include "src/ChunkAllocator.h"
+#include "src/ConcurrentChunkAllocator.h"
+
+
+// Allocations per thread in every pattern.
+const size_t OPERATIONS = 1 << 20;
+// Blocks a thread keeps alive at once.
+const size_t WORKING_SET = 4096;
+const size_t MIN_BYTES = 16;
+const size_t MAX_BYTES = 256;
+const size_t CHUNK_SIZE = 1 << 19;
+
+// Every allocator under test is driven through this byte interface. Blocks
+// are handed out as uint64_t so that the chunk allocators keep them 8-byte
+// aligned.
+struct MallocBackend {
+    void* Allocate(size_t bytes) {
+        return std::malloc(bytes);
+    }
+    void Deallocate(void* p, size_t) {
+        std::free(p);
+    }
+};
+
+template <class Allocator>
+struct ChunkBackend {
+    explicit ChunkBackend(const ChunkPolicy& policy = ChunkPolicy())
+        : allocator(CHUNK_SIZE, policy) {
+    }
+
+    static size_t Elements(size_t bytes) {
+        return (bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    }
+    void* Allocate(size_t bytes) {
+        return allocator.allocate(Elements(bytes));
+    }
+    void Deallocate(void* p, size_t bytes) {
+        allocator.deallocate(static_cast<uint64_t*>(p), Elements(bytes));
+    }
+
+    Allocator allocator;
+};
+
+// Chunks on huge pages that double in size, up to 64 MiB.
+template <class Allocator>
+struct HugePageChunkBackend : ChunkBackend<Allocator> {
+    HugePageChunkBackend() : ChunkBackend<Allocator>(Policy()) {
+    }
+
+    static ChunkPolicy Policy() {
+        ChunkPolicy policy;
+        policy.huge_pages = true;
+        policy.growth = 2;
+        policy.max_chunk_size = 64 << 20;
+        return policy;
+    }
+};
+
+template <class Resource>
+struct PmrBackend {
+    void* Allocate(size_t bytes) {
+        return resource.allocate(bytes);
+    }
+    void Deallocate(void* p, size_t bytes) {
+        resource.deallocate(p, bytes);
+    }
+
+    Resource resource;
+};
+
+
+size_t RandomBytes(std::mt19937& rand) {
+    return MIN_BYTES + rand() % (MAX_BYTES - MIN_BYTES + 1);
+}
+
+struct Block {
+    void* p;
+    size_t bytes;
+};
+
+// Each thread allocates and frees in a tight loop, in LIFO order within
+// small bursts.
+template <class Backend>
+void Churn(Backend& backend, size_t thread) {
+    std::mt19937 rand(thread);
+    std::vector<Block> burst(64);
+    for (size_t done = 0; done < OPERATIONS; done += burst.size()) {
+        for (auto& block : burst) {
+            block.bytes = RandomBytes(rand);
+            block.p = backend.Allocate(block.bytes);
+            static_cast<char*>(block.p)[0] = 1;
+        }
+        for (auto it = burst.rbegin(); it != burst.rend(); ++it) {
+            backend.Deallocate(it->p, it->bytes);
+        }
+    }
+}
+
+// Each thread keeps a working set of live blocks and replaces random ones,
+// so frees come in no particular order and memory stays fragmented.
+template <class Backend>
+void WorkingSet(Backend& backend, size_t thread) {
+    std::mt19937 rand(thread);
+    std::vector<Block> live(WORKING_SET);
+    for (auto& block : live) {
+        block.bytes = RandomBytes(rand);
+        block.p = backend.Allocate(block.bytes);
+    }
+    for (size_t i = 0; i < OPERATIONS; ++i) {
+        Block& block = live[rand() % live.size()];
+        backend.Deallocate(block.p, block.bytes);
+        block.bytes = RandomBytes(rand);
+        block.p = backend.Allocate(block.bytes);
+        static_cast<char*>(block.p)[0] = 1;
+    }
+    for (auto& block : live) {
+        backend.Deallocate(block.p, block.bytes);
+    }
+}
+
+// Blocks are allocated by one thread and freed by the next one, as with
+// messages passed down a pipeline.
+template <class Backend>
+void Handoff(Backend& backend, size_t thread, std::vector<std::vector<Block>>& mailboxes,
+             size_t threads) {
+    std::mt19937 rand(thread);
+    std::vector<Block>& inbox = mailboxes[thread];
+    std::vector<Block>& outbox = mailboxes[threads + (thread + 1) % threads];
+    for (auto& block : inbox) {
+        backend.Deallocate(block.p, block.bytes);
+    }
+    inbox.clear();
+    for (size_t i = 0; i < OPERATIONS; ++i) {
+        size_t bytes = RandomBytes(rand);
+        outbox.push_back(Block{backend.Allocate(bytes), bytes});
+    }
+}
+
+
+template <class F>
+double MillionOpsPerSecond(size_t threads, F f) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back(f, t);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return threads * OPERATIONS / elapsed.count() / 1e6;
+}
+
+template <class Backend>
+void BenchBackend(const char* name, size_t threads) {
+    double churn, working_set, handoff;
+    {
+        Backend backend;
+        churn = MillionOpsPerSecond(threads, [&](size_t t) { Churn(backend, t); });
+    }
+    {
+        Backend backend;
+        working_set = MillionOpsPerSecond(threads, [&](size_t t) { WorkingSet(backend, t); });
+    }
+    {
+        // Threads free the first half of the mailboxes and fill the second
+        // half, which becomes the first half of the next round. Only the
+        // second round, which both frees and allocates, is reported.
+        Backend backend;
+        std::vector<std::vector<Block>> mailboxes(2 * threads);
+        auto round = [&](size_t t) { Handoff(backend, t, mailboxes, threads); };
+        MillionOpsPerSecond(threads, round);
+        std::rotate(mailboxes.begin(), mailboxes.begin() + threads, mailboxes.end());
+        handoff = MillionOpsPerSecond(threads, round);
+        std::rotate(mailboxes.begin(), mailboxes.begin() + threads, mailboxes.end());
+        for (size_t t = 0; t < threads; ++t) {
+            for (auto& block : mailboxes[t]) {
+                backend.Deallocate(block.p, block.bytes);
+            }
+        }
+    }
+    std::printf("%8zu %-30s %10.2f %12.2f %10.2f\n", threads, name, churn, working_set, handoff);
+}
+
+
+int main() {
+    std::printf("Million allocations per second, %zu-%zu byte blocks\n", MIN_BYTES, MAX_BYTES);
+    std::printf("%8s %-30s %10s %12s %10s\n", "threads", "allocator", "churn", "working set",
+                "handoff");
+
+    BenchBackend<ChunkBackend<ChunkAllocator<uint64_t>>>("ChunkAllocator", 1);
+    BenchBackend<HugePageChunkBackend<ChunkAllocator<uint64_t>>>("ChunkAllocator huge pages", 1);
+    BenchBackend<PmrBackend<std::pmr::unsynchronized_pool_resource>>("pmr unsynchronized_pool", 1);
+    for (size_t threads = 1; threads <= 8; threads *= 2) {
+        BenchBackend<MallocBackend>("malloc", threads);
+        BenchBackend<ChunkBackend<ConcurrentChunkAllocator<uint64_t>>>("ConcurrentChunkAllocator",
+                                                                        threads);
+        BenchBackend<HugePageChunkBackend<ConcurrentChunkAllocator<uint64_t>>>(
+            "ConcurrentChunkAllocator huge", threads);
+        BenchBackend<PmrBackend<std::pmr::synchronized_pool_resource>>("pmr synchronized_pool",
+                                                                       threads);
+        std::printf("\n");
+    }
+}
@@ -0,0 +1,107 @@
+// Replays a trace written by ChunkAllocator::startTrace against fresh arenas
+// with other chunk sizes, to pick one for the traced workload:
+//
+//   g++ -std=c++17 -O2 -I./ bench/trace_replay.cpp -o trace_replay
+//   ./trace_replay trace.bin [chunk size in bytes]...
+//
+// With no sizes given, the traced chunk size and its multiples from 1/4 to
+// 16 times are tried.
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+#include "src/ChunkArena.h"
+
+
+// Statistics of the arena when it held the most chunks. Reserved bytes only
+// grow until a CLEAR event, so that is right before a CLEAR or at the end.
+ChunkStatistics Replay(const std::vector<ChunkTraceEvent>& events, size_t chunk_size) {
+    ChunkArena arena(chunk_size);
+    arena.enableStatistics();
+    // Traced addresses to the blocks that stand for them here.
+    std::unordered_map<uintptr_t, void*> blocks;
+    ChunkStatistics fullest = arena.getStatistics();
+    auto snapshot = [&]() {
+        ChunkStatistics statistics = arena.getStatistics();
+        if (statistics.reserved >= fullest.reserved) {
+            fullest = statistics;
+        }
+    };
+
+    for (const auto& event : events) {
+        switch (event.kind) {
+            case ChunkTraceEvent::ALLOCATE:
+                blocks[event.address] = arena.allocate(event.bytes);
+                break;
+            case ChunkTraceEvent::ALLOCATE_MONOTONIC:
+                blocks[event.address] = arena.allocateMonotonic(event.bytes, event.alignment);
+                break;
+            case ChunkTraceEvent::DEALLOCATE: {
+                auto it = blocks.find(event.address);
+                if (it != blocks.end()) {
+                    arena.deallocate(it->second, event.bytes);
+                    blocks.erase(it);
+                }
+                break;
+            }
+            case ChunkTraceEvent::CLEAR:
+                snapshot();
+                arena.clear();
+                blocks.clear();
+                break;
+        }
+    }
+    snapshot();
+    return fullest;
+}
+
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s trace [chunk size]...\n", argv[0]);
+        return 1;
+    }
+    std::ifstream in(argv[1], std::ios::binary);
+    ChunkTraceReader reader(in);
+    if (!reader.good()) {
+        std::fprintf(stderr, "%s is not a chunk allocator trace\n", argv[1]);
+        return 1;
+    }
+
+    std::vector<ChunkTraceEvent> events;
+    size_t largest_request = 0;
+    ChunkTraceEvent event;
+    while (reader.next(event)) {
+        events.push_back(event);
+        if (event.kind != ChunkTraceEvent::CLEAR && event.bytes > largest_request) {
+            largest_request = event.bytes;
+        }
+    }
+
+    std::vector<size_t> chunk_sizes;
+    for (int i = 2; i < argc; ++i) {
+        chunk_sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    }
+    if (chunk_sizes.empty()) {
+        for (size_t size = std::max<size_t>(reader.getChunkSize() / 4, 1);
+             size <= reader.getChunkSize() * 16; size *= 2) {
+            chunk_sizes.push_back(size);
+        }
+    }
+
+    std::printf("%zu events, largest request %zu bytes, traced chunk size %zu bytes\n",
+                events.size(), largest_request, reader.getChunkSize());
+    std::printf("%12s %8s %14s %14s %12s %9s\n", "chunk size", "chunks", "reserved", "peak in use",
+                "wasted", "hit rate");
+    for (size_t chunk_size : chunk_sizes) {
+        if (chunk_size < largest_request) {
+            std::printf("%12zu  too small for the largest request\n", chunk_size);
+            continue;
+        }
+        ChunkStatistics s = Replay(events, chunk_size);
+        std::printf("%12zu %8zu %14zu %14zu %12zu %8.1f%%\n", chunk_size, s.chunks, s.reserved,
+                    s.peak_in_use, s.wasted, 100 * s.freeListHitRate());
+    }
+}
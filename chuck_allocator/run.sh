@@ -0,0 +1,8 @@
+#!/bin/bash
+
+set -e
+
+g++ -std=c++17 -pthread -I./ -I../list test/test.cpp -o chunk_allocator_test
+./chunk_allocator_test
+
+echo All tests passed!
@@ -1,9 +1,15 @@
 #pragma once
 #include <exception>
-#include <vector>
+#include <new>
+#include <utility>
+
+#include "ChunkArena.h"
 
 template <typename T>
 class ChunkAllocator {
+  static_assert(alignof(T) <= ChunkSizeClass::MAX_ALIGN,
+                "ChunkAllocator does not support this alignment");
+
  public:
   using value_type = T;
   using pointer = T*;
@@ -12,114 +18,35 @@ class ChunkAllocator {
   using const_reference = const T&;
   using size_type = std::size_t;
   using difference_type = std::ptrdiff_t;
+  // Rebound copies share the arena of the allocator they are made from, so
+  // the nodes of a container come from the pool the user configured.
   template <typename U>
   struct rebind {
     typedef ChunkAllocator<U> other;
   };
 
-  template <typename T>
-  class ChunkList {
-    template <typename T>
-    struct Chunk {
-      struct Block {
-        explicit Block(size_t start, size_t size)
-            : start(start), end(start + size - 1) {}
-        Block() = delete;
-        size_t getSize() { return end - start + 1; }
-
-        size_t start;
-        size_t end;
-      };
-      explicit Chunk(size_t size)
-          : chunk_size(size),
-            next(nullptr),
-            mem((T*)(new uint8_t[size * sizeof(T)])) {}
-
-      T* reserve(size_t size) {
-        if (blocks.size() == 0) {
-          blocks.push_back(Block(0, size));
-          return (T*)((uint8_t*)mem);
-        }
-        if (blocks.back().end + 1 + size <= chunk_size) {
-          blocks.push_back(Block(blocks.back().end + 1, size));
-          return (T*)((uint8_t*)mem + blocks.back().end + 1);
-        }
-        return nullptr;
-      }
-
-      Chunk<T>* next;
-      std::vector<Block> blocks;
-      size_t chunk_size;
-      T* mem;
-    };
-
-   public:
-    ChunkList() : head(nullptr), size(0) {}
-    ~ChunkList() { clear(); }
-
-    void clear() {
-      while (head) {
-        Chunk<T>* p = head;
-        head = head->next;
-        delete p;
-      }
-    }
-
-    T* allocate(const size_t n, const size_t chunk_size) {
-      if (head) {
-        T* result;
-        Chunk<T>* cur_chunk = head;
-        Chunk<T>* prev_chunk = nullptr;
-        while (cur_chunk != nullptr) {
-          if ((result = cur_chunk->reserve(n)) != nullptr) {
-            return result;
-          }
-          prev_chunk = cur_chunk;
-          cur_chunk = cur_chunk->next;
-        }
-        prev_chunk->next = new Chunk<T>(chunk_size);
-        return prev_chunk->next->reserve(n);
-      } else {
-        head = new Chunk<T>(chunk_size);
-        return head->reserve(n);
-      }
-    }
+  using FragmentationReport = ChunkArena::FragmentationReport;
 
-   private:
-    Chunk<T>* head;
-    size_t size;   
-  };
-
-  class ReferenceCount {
-   public:
-    ReferenceCount() : ref_count(0) {}
-    void inc() { ++ref_count; }
-    int dec() { return --ref_count; }
-    int getCount() const { return ref_count; }
-
-   private:
-    long long ref_count;
-  };
-
- 
-
-  explicit ChunkAllocator(size_type chunk_size)
-      : chunk_size(chunk_size),
-        ref_count(new ReferenceCount()) {
+  // chunk_size is in bytes, and is also the largest request allowed.
+  explicit ChunkAllocator(size_type chunk_size,
+                          const ChunkPolicy& policy = ChunkPolicy())
+      : arena(new ChunkArena(chunk_size, policy)),
+        ref_count(new ChunkReferenceCount()) {
     ref_count->inc();
   }
 
-  ChunkAllocator()
-      : chunk_size(BASIC_SIZE),
-        ref_count(new ReferenceCount()) {
-    ref_count->inc();
-  }
+  ChunkAllocator() : ChunkAllocator(BASIC_SIZE) {}
 
   // copy constructor
   ChunkAllocator(const ChunkAllocator<value_type>& another)
-      : chunk_list(another.chunk_list),
-        ref_count(another.ref_count),
-        chunk_size(another.chunk_size) {
+      : arena(another.arena), ref_count(another.ref_count) {
+    ref_count->inc();
+  }
+
+  // Shares the arena of an allocator for another type.
+  template <typename U>
+  ChunkAllocator(const ChunkAllocator<U>& another)
+      : arena(another.arena), ref_count(another.ref_count) {
     ref_count->inc();
   }
 
@@ -127,51 +54,76 @@ class ChunkAllocator {
   ChunkAllocator<value_type>& operator=(
       const ChunkAllocator<value_type>& another) {
     if (this != &another) {
-      if (ref_count && ref_count->dec() == 0) {
-        delete ref_count;
-        chunk_list->clear();
-      }
-      chunk_list = another.chunk_list;
+      release();
+      arena = another.arena;
       ref_count = another.ref_count;
-      chunk_size = another.chunk_size;
       ref_count->inc();
     }
     return *this;
   }
 
-  ~ChunkAllocator() {
-    if (ref_count) {
-      if (ref_count->dec() <= 0) {
-        delete ref_count;        
-        ref_count = nullptr;
-        // linked list's destructor invokes automatically
-      }
-    }
-  }
+  ~ChunkAllocator() { release(); }
 
+  // Throws std::bad_alloc if n elements take more bytes than a chunk.
   pointer allocate(const size_type n) {
-    long n_bytes = n * sizeof(T);
-    if (n_bytes > chunk_size) {
+    if (n > arena->getChunkSize() / sizeof(T)) {
       throw std::bad_alloc();
     }
 
-    chunk_list.allocate(n, chunk_size);
+    return static_cast<pointer>(arena->allocate(n * sizeof(T)));
   }
 
-  void deallocate(pointer p, const size_type n) {}
+  // The block goes to the free list of its size class and is handed out
+  // again by a later allocate of that class, for this type or another.
+  void deallocate(pointer p, const size_type n) {
+    arena->deallocate(p, n * sizeof(T));
+  }
 
-  template <typename T, typename... Args>
-  void construct(T* p, const Args&&... args) {
-    new (p) T(std::forward<const Args>(args)...);
+  template <typename U, typename... Args>
+  void construct(U* p, Args&&... args) {
+    new (p) U(std::forward<Args>(args)...);
   }
 
   void destroy(pointer p) { p->~T(); }
 
+  FragmentationReport getFragmentationReport() const {
+    return arena->report();
+  }
+
+  // Statistics and traces belong to the arena, so they cover every copy of
+  // the allocator, rebound ones included.
+  void enableStatistics() { arena->enableStatistics(); }
+  ChunkStatistics getStatistics() const { return arena->getStatistics(); }
+  void startTrace(std::ostream& out) { arena->startTrace(out); }
+  void stopTrace() { arena->stopTrace(); }
+
+  // Copies share one arena, so memory from one copy may be freed by
+  // another, rebound ones included.
+  template <typename U>
+  bool operator==(const ChunkAllocator<U>& another) const {
+    return arena == another.arena;
+  }
+  template <typename U>
+  bool operator!=(const ChunkAllocator<U>& another) const {
+    return !(*this == another);
+  }
+
  private:
-  ChunkList <value_type> chunk_list;
-  size_type chunk_size;
-  ReferenceCount* ref_count = nullptr;
-  static const size_type BASIC_SIZE = 1024;
+  template <typename U>
+  friend class ChunkAllocator;
 
-  size_type getChunkSize() { return chunk_size; }
-};
\ No newline at end of file
+  ChunkArena* arena;
+  ChunkReferenceCount* ref_count = nullptr;
+  static const size_type BASIC_SIZE = 4096;
+
+  size_type getChunkSize() { return arena->getChunkSize(); }
+
+  void release() {
+    if (ref_count && ref_count->dec() <= 0) {
+      delete ref_count;
+      delete arena;
+    }
+    ref_count = nullptr;
+    arena = nullptr;
+  }
+};
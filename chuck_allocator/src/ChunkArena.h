@@ -0,0 +1,308 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <ostream>
+
+#include "ChunkPolicy.h"
+#include "ChunkTrace.h"
+
+// Size classes shared by the chunk allocators, in bytes: multiples of 16 up
+// to 256, then four classes per doubling. Blocks are rounded up to their
+// class, so a deallocated block can serve any later request of its class,
+// whatever type it was allocated for.
+//
+// A block is aligned to the largest power of two dividing its class size,
+// up to MAX_ALIGN. A request for n elements of T is a multiple of
+// alignof(T) and so is the class it rounds up to, so the block is aligned
+// for T.
+struct ChunkSizeClass {
+  // A free block keeps the next free block of its class in its first bytes.
+  static constexpr size_t MIN_BLOCK = 16;
+  static constexpr size_t MAX_ALIGN = 4096;
+  static constexpr size_t COUNT = 16 + (64 - 8) * 4;
+
+  static size_t index(size_t bytes) {
+    if (bytes <= 256) {
+      return bytes <= MIN_BLOCK ? 0 : (bytes - 1) / 16;
+    }
+    // bytes is in (2^k, 2^(k + 1)], which holds four classes.
+    size_t k = 63 - __builtin_clzll(bytes - 1);
+    return 16 + (k - 8) * 4 + ((bytes - 1 - (size_t(1) << k)) >> (k - 2));
+  }
+
+  static size_t size(size_t index) {
+    if (index < 16) {
+      return (index + 1) * 16;
+    }
+    size_t k = 8 + (index - 16) / 4;
+    return (size_t(1) << k) + ((index - 16) % 4 + 1) * (size_t(1) << (k - 2));
+  }
+
+  static size_t alignment(size_t size) {
+    size_t lowest_bit = size & (~size + 1);
+    return lowest_bit < MAX_ALIGN ? lowest_bit : MAX_ALIGN;
+  }
+
+  static void* loadLink(void* block) { return *static_cast<void**>(block); }
+  static void storeLink(void* block, void* next) {
+    *static_cast<void**>(block) = next;
+  }
+};
+
+// Copies of a chunk allocator share one count of their arena's users,
+// whatever type each copy is for.
+class ChunkReferenceCount {
+ public:
+  ChunkReferenceCount() : ref_count(0) {}
+  void inc() { ++ref_count; }
+  int dec() { return --ref_count; }
+  int getCount() const { return ref_count; }
+
+ private:
+  long long ref_count;
+};
+
+// Snapshot of what a ChunkArena has done. The byte totals are always kept;
+// the rest only while statistics are enabled, and is zero otherwise.
+struct ChunkStatistics {
+  size_t reserved;  // bytes in chunks
+  size_t in_use;    // bytes in blocks handed out
+  size_t wasted;    // bytes lost to rounding up to size classes, alignment
+                    // padding and abandoned chunk tails
+  size_t chunks;
+
+  bool enabled;
+  size_t peak_in_use;
+  size_t allocations;
+  size_t deallocations;
+  size_t free_list_hits;  // allocations served from a free list
+  // Indexed by ChunkSizeClass::index of the requested size.
+  std::array<size_t, ChunkSizeClass::COUNT> allocations_by_class;
+
+  double freeListHitRate() const {
+    return allocations ? double(free_list_hits) / allocations : 0.;
+  }
+};
+
+// Chunks and free lists behind ChunkAllocator, in bytes, so that the
+// allocator and all its rebound copies can share one arena.
+class ChunkArena {
+ public:
+  // Where the bytes of all chunks currently are.
+  struct FragmentationReport {
+    size_t reserved;     // total size of the chunks
+    size_t in_use;       // blocks handed out and not deallocated yet
+    size_t requested;    // what callers asked for; the rest of in_use is
+                         // lost to rounding up to a size class
+    size_t free_listed;  // deallocated blocks waiting to be reused
+    size_t untouched;    // rest of the current chunk
+    size_t abandoned;    // alignment padding, and tails of earlier chunks
+                         // too short for the request that made the arena
+                         // move on
+  };
+
+  // Requests are limited to chunk_size bytes. Chunks are at least the class
+  // size of chunk_size and aligned for any class up to it.
+  ChunkArena(size_t chunk_size, const ChunkPolicy& policy = ChunkPolicy())
+      : head(nullptr),
+        size(0),
+        chunk_size(chunk_size),
+        first_chunk(ChunkSizeClass::size(ChunkSizeClass::index(chunk_size))),
+        chunk_alignment(ChunkSizeClass::MAX_ALIGN),
+        policy(policy) {
+    while (chunk_alignment > first_chunk) {
+      chunk_alignment /= 2;
+    }
+    clearFreeLists();
+  }
+  ~ChunkArena() { clear(); }
+
+  ChunkArena(const ChunkArena&) = delete;
+  ChunkArena& operator=(const ChunkArena&) = delete;
+
+  size_t getChunkSize() const { return chunk_size; }
+
+  // Statistics and traces cost a branch per request while off.
+  void enableStatistics() {
+    if (!counters) {
+      counters.reset(new ChunkStatistics());
+      counters->enabled = true;
+      counters->peak_in_use = in_use;
+    }
+  }
+
+  ChunkStatistics getStatistics() const {
+    ChunkStatistics result = counters ? *counters : ChunkStatistics();
+    FragmentationReport fragmentation = report();
+    result.reserved = fragmentation.reserved;
+    result.in_use = fragmentation.in_use;
+    result.wasted = fragmentation.in_use - fragmentation.requested +
+                    fragmentation.abandoned;
+    result.chunks = size;
+    return result;
+  }
+
+  // Writes every later request to out, which must outlive the trace; see
+  // ChunkTrace.h for the format.
+  void startTrace(std::ostream& out) {
+    trace.reset(new ChunkTraceWriter(out, chunk_size));
+  }
+  void stopTrace() { trace.reset(); }
+
+  void clear() {
+    if (trace) {
+      trace->write(ChunkTraceEvent::CLEAR, 0, nullptr);
+    }
+    while (head) {
+      Chunk* p = head;
+      head = head->next;
+      policy.deallocateChunk(p->mem, p->bytes, chunk_alignment);
+      delete p;
+    }
+    size = 0;
+    clearFreeLists();
+  }
+
+  // Deallocated blocks are found in O(1) on the free list of their class.
+  void* allocate(const size_t bytes) {
+    size_t size_class = ChunkSizeClass::index(bytes);
+    size_t capacity = ChunkSizeClass::size(size_class);
+    void* result = free_lists[size_class];
+    bool hit = result;
+    if (hit) {
+      free_lists[size_class] = ChunkSizeClass::loadLink(result);
+      free_listed -= capacity;
+    } else {
+      result = reserve(capacity, ChunkSizeClass::alignment(capacity));
+    }
+    in_use += capacity;
+    requested += bytes;
+    if (counters) {
+      countAllocation(size_class, hit);
+    }
+    if (trace) {
+      trace->write(ChunkTraceEvent::ALLOCATE, bytes, result);
+    }
+    return result;
+  }
+
+  // bytes must be what was passed to allocate for p.
+  void deallocate(void* p, const size_t bytes) {
+    size_t size_class = ChunkSizeClass::index(bytes);
+    size_t capacity = ChunkSizeClass::size(size_class);
+    ChunkSizeClass::storeLink(p, free_lists[size_class]);
+    free_lists[size_class] = p;
+    free_listed += capacity;
+    in_use -= capacity;
+    requested -= bytes;
+    if (counters) {
+      counters->deallocations++;
+    }
+    if (trace) {
+      trace->write(ChunkTraceEvent::DEALLOCATE, bytes, p);
+    }
+  }
+
+  // Exactly bytes from the current chunk, with no size class; the block is
+  // never reused and only goes away with the whole arena. alignment must
+  // not exceed chunk_size.
+  void* allocateMonotonic(const size_t bytes, const size_t alignment) {
+    void* result = reserve(bytes, alignment);
+    in_use += bytes;
+    requested += bytes;
+    if (counters) {
+      countAllocation(ChunkSizeClass::index(bytes), false);
+    }
+    if (trace) {
+      trace->write(ChunkTraceEvent::ALLOCATE_MONOTONIC, bytes, result,
+                   alignment);
+    }
+    return result;
+  }
+
+  FragmentationReport report() const {
+    FragmentationReport result;
+    result.reserved = reserved;
+    result.in_use = in_use;
+    result.requested = requested;
+    result.free_listed = free_listed;
+    result.untouched = head ? head->bytes - head->used : 0;
+    result.abandoned = reserved - in_use - free_listed - result.untouched;
+    return result;
+  }
+
+ private:
+  struct Chunk {
+    Chunk(char* mem, size_t bytes)
+        : bytes(bytes), used(0), next(nullptr), mem(mem) {}
+
+    // Bump allocation; null if the rest of the chunk is too short.
+    void* reserve(size_t size, size_t alignment) {
+      size_t offset = (used + alignment - 1) & ~(alignment - 1);
+      if (offset > bytes || size > bytes - offset) {
+        return nullptr;
+      }
+      used = offset + size;
+      return mem + offset;
+    }
+
+    size_t bytes;
+    size_t used;
+    Chunk* next;
+    char* mem;
+  };
+
+  // The chunk new blocks are carved from; older chunks follow it and are
+  // only walked on teardown.
+  Chunk* head;
+  size_t size;
+  const size_t chunk_size;
+  const size_t first_chunk;
+  size_t chunk_alignment;
+  const ChunkPolicy policy;
+  std::array<void*, ChunkSizeClass::COUNT> free_lists;
+  size_t reserved = 0;
+  size_t in_use = 0;
+  size_t requested = 0;
+  size_t free_listed = 0;
+  std::unique_ptr<ChunkStatistics> counters;
+  std::unique_ptr<ChunkTraceWriter> trace;
+
+  void countAllocation(size_t size_class, bool free_list_hit) {
+    counters->allocations++;
+    counters->allocations_by_class[size_class]++;
+    if (free_list_hit) {
+      counters->free_list_hits++;
+    }
+    if (in_use > counters->peak_in_use) {
+      counters->peak_in_use = in_use;
+    }
+  }
+
+  void clearFreeLists() {
+    free_lists.fill(nullptr);
+    reserved = in_use = requested = free_listed = 0;
+  }
+
+  void* reserve(const size_t bytes, const size_t alignment) {
+    if (head) {
+      if (void* result = head->reserve(bytes, alignment)) {
+        return result;
+      }
+    }
+    // With growth, the size of the chunk depends on how many came before
+    // it; requests are still limited by chunk_size.
+    size_t chunk_bytes = policy.chunkSize(first_chunk, size);
+    char* mem =
+        static_cast<char*>(policy.allocateChunk(chunk_bytes, chunk_alignment));
+    Chunk* chunk = new Chunk(mem, chunk_bytes);
+    reserved += chunk->bytes;
+    size++;
+    chunk->next = head;
+    head = chunk;
+    return head->reserve(bytes, alignment);
+  }
+};
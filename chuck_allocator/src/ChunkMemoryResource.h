@@ -0,0 +1,128 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+
+#include "ChunkArena.h"
+
+// std::pmr::memory_resource adapters over the arena of ChunkAllocator, so
+// that std::pmr containers and task::list with a polymorphic_allocator can
+// draw from chunks without being instantiated for another allocator.
+//
+// Requests with an alignment up to ChunkSizeClass::MAX_ALIGN are served
+// from the arena. Over-aligned requests and requests larger than a chunk
+// are passed to the upstream resource.
+class ChunkMemoryResource : public std::pmr::memory_resource {
+ public:
+  using FragmentationReport = ChunkArena::FragmentationReport;
+
+  ChunkMemoryResource(const ChunkMemoryResource&) = delete;
+  ChunkMemoryResource& operator=(const ChunkMemoryResource&) = delete;
+
+  std::pmr::memory_resource* upstream_resource() const { return upstream; }
+
+  size_t getChunkSize() const { return arena.getChunkSize(); }
+
+  FragmentationReport getFragmentationReport() const {
+    return arena.report();
+  }
+
+  // Cover arena blocks only, not the upstream resource.
+  void enableStatistics() { arena.enableStatistics(); }
+  ChunkStatistics getStatistics() const { return arena.getStatistics(); }
+  void startTrace(std::ostream& out) { arena.startTrace(out); }
+  void stopTrace() { arena.stopTrace(); }
+
+  // Frees all chunks at once; blocks handed out from them become invalid.
+  // Blocks from the upstream resource are not affected.
+  void release() { arena.clear(); }
+
+ protected:
+  static const size_t BASIC_SIZE = 1 << 16;
+
+  ChunkMemoryResource(size_t chunk_bytes, const ChunkPolicy& policy,
+                      std::pmr::memory_resource* upstream)
+      : arena(chunk_bytes, policy), upstream(upstream) {}
+
+  // Rounding up to the alignment makes the size class a multiple of it, so
+  // pooled blocks come out aligned.
+  static size_t blockSize(size_t bytes, size_t alignment) {
+    size_t size = (bytes + alignment - 1) & ~(alignment - 1);
+    return size == 0 ? alignment : size;
+  }
+
+  // Depends only on the arguments, so deallocate takes the same way back
+  // as allocate did.
+  bool fromPool(size_t bytes, size_t alignment) const {
+    return alignment <= ChunkSizeClass::MAX_ALIGN &&
+           bytes <= arena.getChunkSize() &&
+           blockSize(bytes, alignment) <= arena.getChunkSize();
+  }
+
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+  ChunkArena arena;
+  std::pmr::memory_resource* const upstream;
+};
+
+// Bump allocation only, like std::pmr::monotonic_buffer_resource:
+// deallocate does nothing for arena blocks, and memory comes back on
+// release or destruction.
+class MonotonicChunkResource : public ChunkMemoryResource {
+ public:
+  explicit MonotonicChunkResource(
+      size_t chunk_bytes = BASIC_SIZE,
+      std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+      : MonotonicChunkResource(chunk_bytes, ChunkPolicy(), upstream) {}
+  MonotonicChunkResource(
+      size_t chunk_bytes, const ChunkPolicy& policy,
+      std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+      : ChunkMemoryResource(chunk_bytes, policy, upstream) {}
+
+ protected:
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    if (!fromPool(bytes, alignment)) {
+      return upstream->allocate(bytes, alignment);
+    }
+    return arena.allocateMonotonic(bytes == 0 ? 1 : bytes, alignment);
+  }
+
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+    if (!fromPool(bytes, alignment)) {
+      upstream->deallocate(p, bytes, alignment);
+    }
+  }
+};
+
+// Blocks are rounded up to a size class and reused through the free lists
+// of the arena, like std::pmr::unsynchronized_pool_resource. Not
+// thread-safe.
+class PooledChunkResource : public ChunkMemoryResource {
+ public:
+  explicit PooledChunkResource(
+      size_t chunk_bytes = BASIC_SIZE,
+      std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+      : PooledChunkResource(chunk_bytes, ChunkPolicy(), upstream) {}
+  PooledChunkResource(
+      size_t chunk_bytes, const ChunkPolicy& policy,
+      std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+      : ChunkMemoryResource(chunk_bytes, policy, upstream) {}
+
+ protected:
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    if (!fromPool(bytes, alignment)) {
+      return upstream->allocate(bytes, alignment);
+    }
+    return arena.allocate(blockSize(bytes, alignment));
+  }
+
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+    if (!fromPool(bytes, alignment)) {
+      upstream->deallocate(p, bytes, alignment);
+      return;
+    }
+    arena.deallocate(p, blockSize(bytes, alignment));
+  }
+};
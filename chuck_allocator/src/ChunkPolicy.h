@@ -0,0 +1,162 @@
+#pragma once
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <new>
+
+// Where the chunk allocators get their chunks and how large the chunks get.
+// The default is chunks of one size from operator new.
+struct ChunkPolicy {
+  // Map chunks with mmap instead of operator new.
+  bool mmap = false;
+  // Back mapped chunks with huge pages: MAP_HUGETLB if the system has huge
+  // pages reserved, otherwise a huge-page-aligned mapping advised with
+  // MADV_HUGEPAGE for transparent huge pages. Chunks are rounded up to
+  // hugePageSize(). Implies mmap.
+  bool huge_pages = false;
+  // Fault mapped chunks in when they are mapped rather than one page at a
+  // time on first touch: MAP_POPULATE, or for transparent huge pages a
+  // prefault after MADV_HUGEPAGE so that the pages come in huge. Implies
+  // mmap.
+  bool populate = false;
+  // Every chunk is growth times the size of the one before, up to
+  // max_chunk_size bytes, or with no limit if that is 0.
+  size_t growth = 1;
+  size_t max_chunk_size = 0;
+
+  // Size of a transparent huge page as reported by the kernel, or 2 MiB, the
+  // x86-64 size, where that is not available.
+  static size_t hugePageSize() {
+    static const size_t size = [] {
+      size_t bytes = 0;
+      std::ifstream in("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size");
+      if (!(in >> bytes) || bytes == 0 || (bytes & (bytes - 1)) != 0) {
+        bytes = 2 << 20;
+      }
+      return bytes;
+    }();
+    return size;
+  }
+
+  bool mapped() const { return mmap || huge_pages || populate; }
+
+  // Size in bytes of the chunk after one of size bytes.
+  size_t nextChunkSize(size_t size) const {
+    if (growth <= 1 || size > SIZE_MAX / growth) {
+      return size;
+    }
+    size_t next = size * growth;
+    if (max_chunk_size && next > max_chunk_size) {
+      next = max_chunk_size > size ? max_chunk_size : size;
+    }
+    return next;
+  }
+
+  // Size in bytes of chunk number index, counting from 0, when the first
+  // one has first bytes.
+  size_t chunkSize(size_t first, size_t index) const {
+    size_t size = first;
+    for (size_t i = 0; i < index; i++) {
+      size_t next = nextChunkSize(size);
+      if (next == size) {
+        break;
+      }
+      size = next;
+    }
+    return size;
+  }
+
+  // Returns a chunk of at least bytes bytes aligned to alignment, and
+  // stores its real size in bytes. Throws std::bad_alloc on failure.
+  void* allocateChunk(size_t& bytes, size_t alignment) const {
+    if (!mapped() || alignment > pageSize()) {
+      return ::operator new(bytes, std::align_val_t(alignment));
+    }
+    if (huge_pages) {
+      bytes = roundUp(bytes, hugePageSize());
+#ifdef MAP_HUGETLB
+      if (void* p = map(bytes, MAP_HUGETLB | populateFlag())) {
+        return p;
+      }
+#endif
+      return mapAligned(bytes, hugePageSize());
+    }
+    bytes = roundUp(bytes, pageSize());
+    if (void* p = map(bytes, populateFlag())) {
+      return p;
+    }
+    throw std::bad_alloc();
+  }
+
+  // bytes and alignment must be what allocateChunk was given and stored.
+  void deallocateChunk(void* p, size_t bytes, size_t alignment) const {
+    if (!mapped() || alignment > pageSize()) {
+      ::operator delete(p, std::align_val_t(alignment));
+      return;
+    }
+    munmap(p, bytes);
+  }
+
+ private:
+  static size_t pageSize() {
+    static const size_t size = sysconf(_SC_PAGESIZE);
+    return size;
+  }
+
+  static size_t roundUp(size_t bytes, size_t unit) {
+    return (bytes + unit - 1) / unit * unit;
+  }
+
+  int populateFlag() const {
+#ifdef MAP_POPULATE
+    return populate ? MAP_POPULATE : 0;
+#else
+    return 0;
+#endif
+  }
+
+  void* map(size_t bytes, int flags) const {
+    void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+    return p == MAP_FAILED ? nullptr : p;
+  }
+
+  // Transparent huge pages only back whole aligned huge pages, so map one
+  // more than needed and trim the ends. Pages faulted in before the advice
+  // would be small ones, so populating waits until after madvise.
+  void* mapAligned(size_t bytes, size_t alignment) const {
+    char* p = static_cast<char*>(map(bytes + alignment, 0));
+    if (!p) {
+      throw std::bad_alloc();
+    }
+    char* aligned = reinterpret_cast<char*>(
+        roundUp(reinterpret_cast<uintptr_t>(p), alignment));
+    if (aligned != p) {
+      munmap(p, aligned - p);
+    }
+    munmap(aligned + bytes, p + alignment - aligned);
+#ifdef MADV_HUGEPAGE
+    madvise(aligned, bytes, MADV_HUGEPAGE);
+#endif
+    if (populate) {
+      prefault(aligned, bytes);
+    }
+    return aligned;
+  }
+
+  // Kernels before 5.14 reject MADV_POPULATE_WRITE; writing one byte per
+  // page faults the range in as well.
+  static void prefault(char* p, size_t bytes) {
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(p, bytes, MADV_POPULATE_WRITE) == 0) {
+      return;
+    }
+#endif
+    for (size_t offset = 0; offset < bytes; offset += pageSize()) {
+      static_cast<volatile char*>(p)[offset] = 0;
+    }
+  }
+};
@@ -0,0 +1,150 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+// Binary trace of the requests made to a ChunkArena, for replaying them
+// offline against other chunk sizes and policies.
+//
+// The trace starts with the magic "CHTR", a version byte and the chunk size
+// of the arena. Every event is then a kind byte followed by unsigned LEB128
+// varints: the size in bytes, the block address as a zigzag delta from the
+// address of the previous event, and for ALLOCATE_MONOTONIC the alignment.
+// Consecutive blocks of a chunk lie close together, so most events take
+// only a few bytes.
+struct ChunkTraceEvent {
+  enum Kind : uint8_t {
+    ALLOCATE = 1,
+    DEALLOCATE = 2,
+    ALLOCATE_MONOTONIC = 3,
+    // The arena freed all chunks at once.
+    CLEAR = 4,
+  };
+
+  Kind kind;
+  size_t bytes;
+  uintptr_t address;
+  size_t alignment;
+};
+
+class ChunkTraceWriter {
+ public:
+  // out must outlive the writer; events reach it in batches.
+  ChunkTraceWriter(std::ostream& out, size_t chunk_size)
+      : out(out), last_address(0) {
+    buffer.insert(buffer.end(), MAGIC, MAGIC + 4);
+    buffer.push_back(VERSION);
+    putVarint(chunk_size);
+  }
+  ~ChunkTraceWriter() { flush(); }
+
+  ChunkTraceWriter(const ChunkTraceWriter&) = delete;
+  ChunkTraceWriter& operator=(const ChunkTraceWriter&) = delete;
+
+  void write(ChunkTraceEvent::Kind kind, size_t bytes, const void* p,
+             size_t alignment = 0) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(p);
+    buffer.push_back(kind);
+    putVarint(bytes);
+    // Zigzag encoding keeps small negative deltas short.
+    uintptr_t delta = address - last_address;
+    putVarint((delta << 1) ^ -(delta >> (sizeof(delta) * 8 - 1)));
+    if (kind == ChunkTraceEvent::ALLOCATE_MONOTONIC) {
+      putVarint(alignment);
+    }
+    last_address = address;
+    if (buffer.size() >= BUFFER_SIZE) {
+      flush();
+    }
+  }
+
+  void flush() {
+    out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    out.flush();
+    buffer.clear();
+  }
+
+  static constexpr char MAGIC[4] = {'C', 'H', 'T', 'R'};
+  static constexpr uint8_t VERSION = 1;
+
+ private:
+  static const size_t BUFFER_SIZE = 1 << 16;
+
+  std::ostream& out;
+  std::vector<uint8_t> buffer;
+  uintptr_t last_address;
+
+  void putVarint(uint64_t value) {
+    while (value >= 0x80) {
+      buffer.push_back(uint8_t(value) | 0x80);
+      value >>= 7;
+    }
+    buffer.push_back(uint8_t(value));
+  }
+};
+
+class ChunkTraceReader {
+ public:
+  // Reads the header; good() is false if in does not hold a trace.
+  explicit ChunkTraceReader(std::istream& in)
+      : in(in), chunk_size(0), last_address(0), valid(false) {
+    char magic[4];
+    if (!in.read(magic, 4) ||
+        !std::equal(magic, magic + 4, ChunkTraceWriter::MAGIC) ||
+        in.get() != ChunkTraceWriter::VERSION) {
+      return;
+    }
+    valid = getVarint(chunk_size);
+  }
+
+  bool good() const { return valid; }
+
+  // Chunk size of the arena the trace was taken from.
+  size_t getChunkSize() const { return chunk_size; }
+
+  // Returns false at the end of the trace or on a truncated event.
+  bool next(ChunkTraceEvent& event) {
+    int kind = in.get();
+    if (!valid || kind == std::char_traits<char>::eof()) {
+      return false;
+    }
+    uint64_t bytes, delta, alignment = 0;
+    if (!getVarint(bytes) || !getVarint(delta)) {
+      return valid = false;
+    }
+    if (kind == ChunkTraceEvent::ALLOCATE_MONOTONIC &&
+        !getVarint(alignment)) {
+      return valid = false;
+    }
+    last_address += (delta >> 1) ^ -(delta & 1);
+    event.kind = ChunkTraceEvent::Kind(kind);
+    event.bytes = bytes;
+    event.address = last_address;
+    event.alignment = alignment;
+    return true;
+  }
+
+ private:
+  std::istream& in;
+  uint64_t chunk_size;
+  uintptr_t last_address;
+  bool valid;
+
+  bool getVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      int byte = in.get();
+      if (byte == std::char_traits<char>::eof()) {
+        return false;
+      }
+      value |= uint64_t(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
@@ -0,0 +1,453 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <utility>
+
+#include "ChunkArena.h"
+
+// Pool behind ConcurrentChunkAllocator, in bytes, so that the allocator and
+// all its rebound copies can share it.
+//
+// Every thread works on its own cache inside the pool: a bump region cut
+// from a chunk it owns and per-size-class free lists, none of which need
+// synchronization. Only refills touch shared state, and all of it is
+// lock-free: a thread takes a whole fresh chunk at a time, and a thread
+// whose free list grows long hands a batch of blocks over to the shared
+// free stack of that class, from which other threads take all blocks at
+// once. A thread that exits hands all its free blocks over, and its cache
+// is adopted by the next thread that comes to the pool.
+class ConcurrentChunkPool {
+ public:
+  // Requests are limited to chunk_size bytes.
+  ConcurrentChunkPool(size_t chunk_size, const ChunkPolicy& policy)
+      : ref_count(1),
+        chunk_size(chunk_size),
+        first_chunk(ChunkSizeClass::size(ChunkSizeClass::index(chunk_size))),
+        chunk_alignment(ChunkSizeClass::MAX_ALIGN),
+        policy(policy),
+        chunk_count(0),
+        id(nextId()),
+        chunks(nullptr),
+        caches(nullptr) {
+    while (chunk_alignment > first_chunk) {
+      chunk_alignment /= 2;
+    }
+    for (auto& head : shared_free) {
+      head.store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  ~ConcurrentChunkPool() {
+    for (ThreadCache* cache = caches.load(); cache;) {
+      ThreadCache* next = cache->next;
+      // A cache still owned by a live thread is deleted by that thread; one
+      // whose thread is exiting is waited for.
+      while (true) {
+        int state = ThreadCache::LIVE;
+        if (cache->state.compare_exchange_weak(state, ThreadCache::POOL_GONE,
+                                               std::memory_order_acq_rel)) {
+          break;
+        }
+        if (state == ThreadCache::EXITED) {
+          delete cache;
+          break;
+        }
+        std::this_thread::yield();
+      }
+      cache = next;
+    }
+    for (Chunk* chunk = chunks.load(); chunk;) {
+      Chunk* next = chunk->next;
+      policy.deallocateChunk(chunk->mem, chunk->bytes, chunk_alignment);
+      delete chunk;
+      chunk = next;
+    }
+  }
+
+  ConcurrentChunkPool(const ConcurrentChunkPool&) = delete;
+  ConcurrentChunkPool& operator=(const ConcurrentChunkPool&) = delete;
+
+  void* allocate(size_t bytes) {
+    if (threadExited()) {
+      ThreadCache* cache = acquireCache();
+      void* result = allocate(cache, bytes);
+      releaseCache(cache);
+      return result;
+    }
+    return allocate(localCache(), bytes);
+  }
+
+  void deallocate(void* p, size_t bytes) {
+    if (threadExited()) {
+      ThreadCache* cache = acquireCache();
+      deallocate(cache, p, bytes);
+      releaseCache(cache);
+      return;
+    }
+    deallocate(localCache(), p, bytes);
+  }
+
+  std::atomic<long long> ref_count;
+  const size_t chunk_size;
+
+ private:
+  // A thread keeps up to FLUSH_THRESHOLD free blocks per class and hands
+  // FLUSH_BATCH of them to the other threads when it has more.
+  static constexpr size_t FLUSH_THRESHOLD = 256;
+  static constexpr size_t FLUSH_BATCH = 128;
+  // Per-thread memo of the caches of recently used pools.
+  static constexpr size_t CACHE_SLOTS = 8;
+
+  struct Chunk {
+    Chunk(char* mem, size_t bytes) : next(nullptr), mem(mem), bytes(bytes) {}
+
+    Chunk* next;
+    char* mem;
+    size_t bytes;
+  };
+
+  // State of one thread in one pool. Only its owner touches it, except for
+  // state, through which the owner and the pool agree on who deletes it.
+  struct ThreadCache {
+    // LIVE: owned by a thread. EXITING: its thread is handing the free
+    // blocks over, and the pool must wait. EXITED: free for the next thread
+    // to adopt, and deleted by the pool. POOL_GONE: the pool is destroyed,
+    // and the owning thread deletes it.
+    enum State { LIVE, EXITING, EXITED, POOL_GONE };
+
+    explicit ThreadCache(ConcurrentChunkPool* pool)
+        : pool(pool),
+          pool_id(pool->id),
+          state(LIVE),
+          next(nullptr),
+          thread_next(nullptr),
+          bump(nullptr),
+          bump_bytes(0),
+          bump_used(0) {
+      free_lists.fill(nullptr);
+      free_counts.fill(0);
+    }
+
+    ConcurrentChunkPool* pool;
+    uint64_t pool_id;
+    std::atomic<int> state;
+    // Next cache of the same pool, and of the same thread.
+    ThreadCache* next;
+    ThreadCache* thread_next;
+    char* bump;
+    size_t bump_bytes;
+    size_t bump_used;
+    std::array<void*, ChunkSizeClass::COUNT> free_lists;
+    // Blocks freed by this thread since the class was last refilled from
+    // or flushed to the shared stack; a lower bound on the list length.
+    std::array<size_t, ChunkSizeClass::COUNT> free_counts;
+  };
+
+  // The caches a thread owns in all pools, handed back when it exits.
+  struct ThreadCaches {
+    ThreadCache* first = nullptr;
+
+    ~ThreadCaches() {
+      while (first) {
+        ThreadCache* cache = first;
+        first = first->thread_next;
+        releaseCache(cache);
+      }
+      threadExited() = true;
+    }
+  };
+
+  struct CacheSlot {
+    uint64_t pool_id;
+    ThreadCache* cache;
+  };
+
+  const size_t first_chunk;
+  size_t chunk_alignment;
+  const ChunkPolicy policy;
+  // Chunks taken so far, which sets the size of the next one when chunks
+  // grow.
+  std::atomic<size_t> chunk_count;
+  // Ids are never reused, so a slot left behind by a destroyed pool can
+  // never match a live one.
+  const uint64_t id;
+  std::atomic<Chunk*> chunks;
+  std::atomic<ThreadCache*> caches;
+  std::array<std::atomic<void*>, ChunkSizeClass::COUNT> shared_free;
+
+  // Set once the thread's ThreadCaches is destroyed. Objects destroyed
+  // later in the thread's exit may still use the pool; each of their calls
+  // borrows a cache and hands it back right away.
+  static bool& threadExited() {
+    static thread_local bool exited = false;
+    return exited;
+  }
+
+  void* allocate(ThreadCache* cache, size_t bytes) {
+    size_t size_class = ChunkSizeClass::index(bytes);
+    size_t capacity = ChunkSizeClass::size(size_class);
+
+    if (!cache->free_lists[size_class]) {
+      refill(cache, size_class);
+    }
+    if (void* result = cache->free_lists[size_class]) {
+      cache->free_lists[size_class] = ChunkSizeClass::loadLink(result);
+      if (cache->free_counts[size_class] > 0) {
+        cache->free_counts[size_class]--;
+      }
+      return result;
+    }
+
+    size_t alignment = ChunkSizeClass::alignment(capacity);
+    size_t offset = (cache->bump_used + alignment - 1) & ~(alignment - 1);
+    if (!cache->bump || offset > cache->bump_bytes ||
+        capacity > cache->bump_bytes - offset) {
+      Chunk* chunk = newChunk();
+      push(chunks, chunk, chunk, [](Chunk* c, Chunk* next) {
+        c->next = next;
+      });
+      cache->bump = chunk->mem;
+      cache->bump_bytes = chunk->bytes;
+      offset = 0;
+    }
+    cache->bump_used = offset + capacity;
+    return cache->bump + offset;
+  }
+
+  void deallocate(ThreadCache* cache, void* p, size_t bytes) {
+    size_t size_class = ChunkSizeClass::index(bytes);
+    ChunkSizeClass::storeLink(p, cache->free_lists[size_class]);
+    cache->free_lists[size_class] = p;
+    if (++cache->free_counts[size_class] > FLUSH_THRESHOLD) {
+      flush(cache, size_class);
+    }
+  }
+
+  static uint64_t nextId() {
+    static std::atomic<uint64_t> next_id(1);
+    return next_id.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Lock-free push of the chain first..last onto a stack.
+  template <typename Node, typename SetNext>
+  static void push(std::atomic<Node*>& head, Node* first, Node* last,
+                   SetNext set_next) {
+    Node* old_head = head.load(std::memory_order_relaxed);
+    do {
+      set_next(last, old_head);
+    } while (!head.compare_exchange_weak(old_head, first,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed));
+  }
+
+  Chunk* newChunk() {
+    size_t index = chunk_count.fetch_add(1, std::memory_order_relaxed);
+    size_t bytes = policy.chunkSize(first_chunk, index);
+    char* mem =
+        static_cast<char*>(policy.allocateChunk(bytes, chunk_alignment));
+    return new Chunk(mem, bytes);
+  }
+
+  ThreadCache* localCache() {
+    static thread_local std::array<CacheSlot, CACHE_SLOTS> slots{};
+    CacheSlot& slot = slots[id % CACHE_SLOTS];
+    if (slot.pool_id == id) {
+      return slot.cache;
+    }
+
+    // Either the thread's cache here lost its slot to another pool, or the
+    // thread has none yet. Caches of destroyed pools are dropped on the way.
+    static thread_local ThreadCaches owned;
+    ThreadCache* cache = nullptr;
+    for (ThreadCache** link = &owned.first; *link;) {
+      ThreadCache* c = *link;
+      if (c->pool_id == id) {
+        cache = c;
+      } else if (c->state.load(std::memory_order_acquire) ==
+                 ThreadCache::POOL_GONE) {
+        *link = c->thread_next;
+        delete c;
+        continue;
+      }
+      link = &c->thread_next;
+    }
+    if (!cache) {
+      cache = acquireCache();
+      cache->thread_next = owned.first;
+      owned.first = cache;
+    }
+    slot = CacheSlot{id, cache};
+    return cache;
+  }
+
+  // Adopts the cache of an exited thread, or makes a new one.
+  ThreadCache* acquireCache() {
+    for (ThreadCache* cache = caches.load(std::memory_order_acquire); cache;
+         cache = cache->next) {
+      int state = ThreadCache::EXITED;
+      if (cache->state.load(std::memory_order_relaxed) == state &&
+          cache->state.compare_exchange_strong(state, ThreadCache::LIVE,
+                                               std::memory_order_acquire)) {
+        cache->thread_next = nullptr;
+        return cache;
+      }
+    }
+    ThreadCache* cache = new ThreadCache(this);
+    push(caches, cache, cache, [](ThreadCache* c, ThreadCache* next) {
+      c->next = next;
+    });
+    return cache;
+  }
+
+  // Called by the owning thread when it is done with the cache: its free
+  // blocks go to the shared stacks and the cache to the next thread. If
+  // the pool is gone already, so is the cache.
+  static void releaseCache(ThreadCache* cache) {
+    int state = ThreadCache::LIVE;
+    if (!cache->state.compare_exchange_strong(state, ThreadCache::EXITING,
+                                              std::memory_order_acq_rel)) {
+      delete cache;
+      return;
+    }
+    ConcurrentChunkPool* pool = cache->pool;
+    for (size_t size_class = 0; size_class < ChunkSizeClass::COUNT;
+         size_class++) {
+      void* first = cache->free_lists[size_class];
+      if (!first) {
+        continue;
+      }
+      void* last = first;
+      while (void* next = ChunkSizeClass::loadLink(last)) {
+        last = next;
+      }
+      push(pool->shared_free[size_class], first, last,
+           ChunkSizeClass::storeLink);
+      cache->free_lists[size_class] = nullptr;
+      cache->free_counts[size_class] = 0;
+    }
+    cache->state.store(ThreadCache::EXITED, std::memory_order_release);
+  }
+
+  // Takes every block other threads handed over for the class. Taking the
+  // whole stack with one exchange avoids the ABA problem of popping single
+  // blocks.
+  void refill(ThreadCache* cache, size_t size_class) {
+    if (!shared_free[size_class].load(std::memory_order_relaxed)) {
+      return;
+    }
+    cache->free_lists[size_class] =
+        shared_free[size_class].exchange(nullptr, std::memory_order_acquire);
+    // The taken blocks are not counted, which would mean touching every
+    // one of them; free_counts only tracks the blocks freed on top.
+    cache->free_counts[size_class] = 0;
+  }
+
+  void flush(ThreadCache* cache, size_t size_class) {
+    void* first = cache->free_lists[size_class];
+    void* last = first;
+    for (size_t i = 1; i < FLUSH_BATCH; i++) {
+      last = ChunkSizeClass::loadLink(last);
+    }
+    cache->free_lists[size_class] = ChunkSizeClass::loadLink(last);
+    cache->free_counts[size_class] -= FLUSH_BATCH;
+    push(shared_free[size_class], first, last, ChunkSizeClass::storeLink);
+  }
+};
+
+// Thread-safe sibling of ChunkAllocator: copies, rebound ones included,
+// share one pool and may be used from any number of threads, and a block
+// may be deallocated by a different thread than the one that allocated it.
+template <typename T>
+class ConcurrentChunkAllocator {
+  static_assert(alignof(T) <= ChunkSizeClass::MAX_ALIGN,
+                "ConcurrentChunkAllocator does not support this alignment");
+
+ public:
+  using value_type = T;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using reference = T&;
+  using const_reference = const T&;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  template <typename U>
+  struct rebind {
+    typedef ConcurrentChunkAllocator<U> other;
+  };
+
+  // chunk_size is in bytes, and is also the largest request allowed.
+  explicit ConcurrentChunkAllocator(size_type chunk_size,
+                                    const ChunkPolicy& policy = ChunkPolicy())
+      : pool(new ConcurrentChunkPool(chunk_size, policy)) {}
+
+  ConcurrentChunkAllocator() : ConcurrentChunkAllocator(BASIC_SIZE) {}
+
+  ConcurrentChunkAllocator(const ConcurrentChunkAllocator& another)
+      : pool(another.pool) {
+    pool->ref_count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Shares the pool of an allocator for another type.
+  template <typename U>
+  ConcurrentChunkAllocator(const ConcurrentChunkAllocator<U>& another)
+      : pool(another.pool) {
+    pool->ref_count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  ConcurrentChunkAllocator& operator=(const ConcurrentChunkAllocator& another) {
+    if (this != &another) {
+      another.pool->ref_count.fetch_add(1, std::memory_order_relaxed);
+      release();
+      pool = another.pool;
+    }
+    return *this;
+  }
+
+  ~ConcurrentChunkAllocator() { release(); }
+
+  // Throws std::bad_alloc if n elements take more bytes than a chunk.
+  pointer allocate(const size_type n) {
+    if (n > pool->chunk_size / sizeof(T)) {
+      throw std::bad_alloc();
+    }
+    return static_cast<pointer>(pool->allocate(n * sizeof(T)));
+  }
+
+  void deallocate(pointer p, const size_type n) {
+    pool->deallocate(p, n * sizeof(T));
+  }
+
+  template <typename U, typename... Args>
+  void construct(U* p, Args&&... args) {
+    new (p) U(std::forward<Args>(args)...);
+  }
+
+  void destroy(pointer p) { p->~T(); }
+
+  template <typename U>
+  bool operator==(const ConcurrentChunkAllocator<U>& another) const {
+    return pool == another.pool;
+  }
+  template <typename U>
+  bool operator!=(const ConcurrentChunkAllocator<U>& another) const {
+    return !(*this == another);
+  }
+
+ private:
+  template <typename U>
+  friend class ConcurrentChunkAllocator;
+
+  static const size_type BASIC_SIZE = 4096;
+
+  ConcurrentChunkPool* pool;
+
+  void release() {
+    if (pool && pool->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete pool;
+    }
+    pool = nullptr;
+  }
+};
@@ -0,0 +1,797 @@
+#include <iostream>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <list>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <memory_resource>
+#include <unordered_map>
+#include <unistd.h>
+#include "src/ChunkAllocator.h"
+#include "src/ChunkMemoryResource.h"
+#include "src/ChunkPolicy.h"
+#include "src/ChunkTrace.h"
+#include "src/ConcurrentChunkAllocator.h"
+#include "src/list.h"
+
+
+size_t RandomUInt(size_t max = -1) {
+    static std::mt19937 rand(std::random_device{}());
+
+    std::uniform_int_distribution<size_t> dist{0, max};
+    return dist(rand);
+}
+
+size_t RandomUInt(size_t min, size_t max) {
+    return min + RandomUInt(max - min);
+}
+
+bool TossCoin() {
+    return RandomUInt(1) == 0;
+}
+
+template <class T>
+void RandomFill(T& container, size_t count, size_t max = -1) {
+    while (count > 0) {
+        container.push_back(RandomUInt(max));
+        --count;
+    }
+}
+
+
+// Passes everything to the default resource and counts what it gets.
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocations = 0;
+    size_t deallocations = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        ++deallocations;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// Cache line sized SIMD buffer.
+struct alignas(64) SimdBlock {
+    double values[8];
+};
+
+bool IsAligned(const void* p, size_t alignment) {
+    return reinterpret_cast<uintptr_t>(p) % alignment == 0;
+}
+
+// Every page of [p, p + bytes) is in memory; p must be page-aligned.
+bool IsResident(void* p, size_t bytes) {
+    size_t page = sysconf(_SC_PAGESIZE);
+    std::vector<unsigned char> pages((bytes + page - 1) / page);
+    if (mincore(p, bytes, pages.data()) != 0) {
+        return false;
+    }
+    return std::all_of(pages.begin(), pages.end(), [](unsigned char flags) { return flags & 1; });
+}
+
+// Every byte of the chunks is in exactly one place.
+bool ReportAddsUp(const ChunkArena::FragmentationReport& report) {
+    return report.reserved == report.in_use + report.free_listed + report.untouched + report.abandoned &&
+           report.requested <= report.in_use;
+}
+
+
+void FailWithMsg(const std::string& msg, int line) {
+    std::cerr << "Test failed!\n";
+    std::cerr << "[Line " << line << "] "  << msg << std::endl;
+    std::exit(EXIT_FAILURE);
+}
+
+#define ASSERT_TRUE(cond) \
+    if (!(cond)) {FailWithMsg("Assertion failed: " #cond, __LINE__);};
+
+#define ASSERT_TRUE_MSG(cond, msg) \
+    if (!(cond)) {FailWithMsg(msg, __LINE__);};
+
+#define ASSERT_EQUAL_MSG(cont1, cont2, msg) \
+    ASSERT_TRUE_MSG(std::equal(cont1.begin(), cont1.end(), cont2.begin(), cont2.end()), msg)
+
+
+int main() {
+
+    {
+        // New blocks are carved one after another from the current chunk.
+        ChunkAllocator<char> allocator(128);
+        char* p = allocator.allocate(32);
+        char* q = allocator.allocate(16);
+        char* r = allocator.allocate(16);
+        ASSERT_TRUE_MSG(q == p + 32 && r == q + 16, "ChunkAllocator bump allocation")
+
+        auto report = allocator.getFragmentationReport();
+        ASSERT_TRUE_MSG(report.reserved == 128, "ChunkAllocator::getFragmentationReport")
+        ASSERT_TRUE_MSG(report.untouched == 128 - 64, "ChunkAllocator::getFragmentationReport")
+        ASSERT_TRUE_MSG(report.abandoned == 0, "ChunkAllocator::getFragmentationReport")
+
+        // A block that does not fit the rest of the chunk starts a new one
+        // and leaves the tail behind.
+        char* s = allocator.allocate(128);
+        ASSERT_TRUE_MSG(s + 128 <= p || s >= p + 128, "ChunkAllocator new chunk")
+        report = allocator.getFragmentationReport();
+        ASSERT_TRUE_MSG(report.reserved == 2 * 128, "ChunkAllocator new chunk")
+        ASSERT_TRUE_MSG(report.untouched == 0, "ChunkAllocator::getFragmentationReport")
+        ASSERT_TRUE_MSG(report.abandoned == 128 - 64, "ChunkAllocator::getFragmentationReport")
+        ASSERT_TRUE_MSG(ReportAddsUp(report), "ChunkAllocator::getFragmentationReport")
+
+        // The next block opens a third chunk; the tail of the first one is
+        // not revisited.
+        char* t = allocator.allocate(16);
+        ASSERT_TRUE_MSG((t + 16 <= p || t >= p + 128) && (t + 16 <= s || t >= s + 128), "ChunkAllocator new chunk")
+        ASSERT_TRUE_MSG(allocator.allocate(16) == t + 16, "ChunkAllocator bump allocation")
+        report = allocator.getFragmentationReport();
+        ASSERT_TRUE_MSG(report.reserved == 3 * 128, "ChunkAllocator new chunk")
+        ASSERT_TRUE_MSG(report.abandoned == 128 - 64, "ChunkAllocator::getFragmentationReport")
+        ASSERT_TRUE_MSG(ReportAddsUp(report), "ChunkAllocator::getFragmentationReport")
+    }
+
+
+    {
+        ChunkAllocator<int> allocator(4096);
+        int* p = allocator.allocate(4);
+        int* q = allocator.allocate(4);
+        ASSERT_TRUE_MSG(p != q, "ChunkAllocator::allocate")
+
+        allocator.deallocate(p, 4);
+        ASSERT_TRUE_MSG(allocator.allocate(4) == p, "Freed block is reused")
+
+        // Three ints round up to the same 16-byte class as four.
+        allocator.deallocate(q, 4);
+        ASSERT_TRUE_MSG(allocator.allocate(3) == q, "Freed block is reused by its size class")
+
+        // Most recently freed first.
+        int* r = allocator.allocate(20);
+        int* s = allocator.allocate(20);
+        allocator.deallocate(r, 20);
+        allocator.deallocate(s, 20);
+        ASSERT_TRUE_MSG(allocator.allocate(20) == s, "Freed block is reused")
+        ASSERT_TRUE_MSG(allocator.allocate(20) == r, "Freed block is reused")
+
+        auto report = allocator.getFragmentationReport();
+        ASSERT_TRUE_MSG(report.free_listed == 0, "ChunkAllocator::getFragmentationReport")
+        ASSERT_TRUE_MSG(report.in_use == 16 + 16 + 80 + 80, "ChunkAllocator::getFragmentationReport")
+        ASSERT_TRUE_MSG(report.requested == 16 + 12 + 80 + 80, "ChunkAllocator::getFragmentationReport")
+        ASSERT_TRUE_MSG(ReportAddsUp(report), "ChunkAllocator::getFragmentationReport")
+    }
+
+
+    {
+        // Blocks are freed and allocated again in random order; the arena
+        // only grows with what is alive at once.
+        const size_t ITER_COUNT = 100000;
+        const size_t MAX_ELEMENTS = 100;
+
+        ChunkAllocator<double> allocator(1 << 16);
+        std::vector<std::pair<double*, size_t>> blocks;
+        size_t in_use = 0;
+        size_t requested = 0;
+        size_t total = 0;
+
+        for (size_t iter = 0; iter < ITER_COUNT; ++iter) {
+            if (blocks.empty() || TossCoin()) {
+                size_t n = RandomUInt(1, MAX_ELEMENTS);
+                double* p = allocator.allocate(n);
+                ASSERT_TRUE_MSG(reinterpret_cast<uintptr_t>(p) % alignof(double) == 0, "ChunkAllocator::allocate alignment")
+                std::fill(p, p + n, static_cast<double>(iter));
+                blocks.emplace_back(p, n);
+                in_use += ChunkSizeClass::size(ChunkSizeClass::index(n * sizeof(double)));
+                requested += n * sizeof(double);
+                total += n * sizeof(double);
+            } else {
+                size_t i = RandomUInt(blocks.size() - 1);
+                auto [p, n] = blocks[i];
+                ASSERT_TRUE_MSG(std::all_of(p, p + n, [p](double x) { return x == *p; }), "Blocks do not overlap")
+                allocator.deallocate(p, n);
+                blocks[i] = blocks.back();
+                blocks.pop_back();
+                in_use -= ChunkSizeClass::size(ChunkSizeClass::index(n * sizeof(double)));
+                requested -= n * sizeof(double);
+            }
+
+            if (iter % 1000 == 0) {
+                auto report = allocator.getFragmentationReport();
+                ASSERT_TRUE_MSG(report.in_use == in_use, "ChunkAllocator::getFragmentationReport")
+                ASSERT_TRUE_MSG(report.requested == requested, "ChunkAllocator::getFragmentationReport")
+                ASSERT_TRUE_MSG(ReportAddsUp(report), "ChunkAllocator::getFragmentationReport")
+            }
+        }
+
+        // Freeing everything makes every used byte free-listed.
+        auto before = allocator.getFragmentationReport();
+        for (auto [p, n] : blocks) {
+            allocator.deallocate(p, n);
+        }
+        auto report = allocator.getFragmentationReport();
+        ASSERT_TRUE_MSG(report.in_use == 0 && report.requested == 0, "ChunkAllocator::getFragmentationReport")
+        ASSERT_TRUE_MSG(report.free_listed == before.free_listed + before.in_use, "ChunkAllocator::getFragmentationReport")
+        ASSERT_TRUE_MSG(report.reserved == before.reserved, "ChunkAllocator::deallocate")
+        ASSERT_TRUE_MSG(ReportAddsUp(report), "ChunkAllocator::getFragmentationReport")
+        ASSERT_TRUE_MSG(report.reserved < total / 10, "Freed blocks are reused")
+    }
+
+
+    {
+        // A growing vector frees its old buffer on every reallocation;
+        // copies of the allocator share the pool.
+        ChunkAllocator<size_t> allocator(1 << 16);
+        std::vector<size_t, ChunkAllocator<size_t>> vector_chunk(allocator);
+        std::vector<size_t> vector_std;
+
+        for (size_t iter = 0; iter < 10; ++iter) {
+            for (size_t count = RandomUInt(100, 1000); count; --count) {
+                size_t value = RandomUInt();
+                vector_chunk.push_back(value);
+                vector_std.push_back(value);
+            }
+            ASSERT_EQUAL_MSG(vector_chunk, vector_std, "std::vector with ChunkAllocator")
+            ASSERT_TRUE_MSG(vector_chunk.get_allocator() == allocator, "Copies share the pool")
+
+            auto report = allocator.getFragmentationReport();
+            size_t bytes = vector_chunk.capacity() * sizeof(size_t);
+            ASSERT_TRUE_MSG(report.in_use == ChunkSizeClass::size(ChunkSizeClass::index(bytes)),
+                            "std::vector with ChunkAllocator")
+            ASSERT_TRUE_MSG(ReportAddsUp(report), "std::vector with ChunkAllocator")
+
+            vector_chunk.clear();
+            vector_chunk.shrink_to_fit();
+            vector_std.clear();
+        }
+        ASSERT_TRUE_MSG(allocator.getFragmentationReport().in_use == 0, "std::vector with ChunkAllocator")
+    }
+
+
+    {
+        ChunkAllocator<size_t> allocator;
+        std::list<size_t, ChunkAllocator<size_t>> list_chunk(allocator);
+        std::list<size_t> list_std;
+
+        for (size_t iter = 0; iter < 10; ++iter) {
+            for (size_t count = RandomUInt(100, 1000); count; --count) {
+                size_t value = RandomUInt();
+                list_chunk.push_back(value);
+                list_std.push_back(value);
+            }
+            ASSERT_EQUAL_MSG(list_chunk, list_std, "std::list with ChunkAllocator")
+
+            auto reserved = allocator.getFragmentationReport().reserved;
+            list_chunk.clear();
+            list_std.clear();
+            auto report = allocator.getFragmentationReport();
+            ASSERT_TRUE_MSG(report.in_use == 0, "std::list with ChunkAllocator")
+            ASSERT_TRUE_MSG(report.reserved == reserved, "std::list with ChunkAllocator")
+        }
+    }
+
+
+    {
+        // Every thread allocates blocks, frees some of its own and hands the
+        // rest to its neighbour to free.
+        const size_t THREAD_COUNT = 4;
+        const size_t ITER_COUNT = 20000;
+
+        ConcurrentChunkAllocator<size_t> allocator(1 << 16);
+        std::vector<std::vector<std::pair<size_t*, size_t>>> handed_over(THREAD_COUNT);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < THREAD_COUNT; ++t) {
+            threads.emplace_back([&allocator, &handed_over, t] {
+                // RandomUInt is not thread-safe.
+                std::mt19937 rand(t);
+                auto random = [&rand](size_t max) { return rand() % (max + 1); };
+
+                ConcurrentChunkAllocator<size_t> copy = allocator;
+                std::vector<std::pair<size_t*, size_t>> own;
+                for (size_t iter = 0; iter < ITER_COUNT; ++iter) {
+                    size_t n = 1 + random(31);
+                    size_t* p = copy.allocate(n);
+                    std::fill(p, p + n, t * ITER_COUNT + iter);
+                    if (random(1)) {
+                        handed_over[t].emplace_back(p, n);
+                    } else {
+                        own.emplace_back(p, n);
+                    }
+                    if (own.size() > 100) {
+                        std::swap(own[random(own.size() - 1)], own.back());
+                        auto [q, m] = own.back();
+                        ASSERT_TRUE_MSG(std::all_of(q, q + m, [q](size_t x) { return x == *q; }), "ConcurrentChunkAllocator blocks do not overlap")
+                        copy.deallocate(q, m);
+                        own.pop_back();
+                    }
+                }
+                for (auto [p, n] : own) {
+                    copy.deallocate(p, n);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        threads.clear();
+        for (size_t t = 0; t < THREAD_COUNT; ++t) {
+            threads.emplace_back([&allocator, &handed_over, t] {
+                for (auto [p, n] : handed_over[(t + 1) % THREAD_COUNT]) {
+                    ASSERT_TRUE_MSG(std::all_of(p, p + n, [p](size_t x) { return x == *p; }), "ConcurrentChunkAllocator blocks do not overlap")
+                    allocator.deallocate(p, n);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+
+    {
+        // Blocks left in the cache of an exited thread go to the next one.
+        const size_t BLOCK_COUNT = 100;
+
+        ConcurrentChunkAllocator<double> allocator(1 << 16);
+        std::set<double*> freed;
+        std::thread([&allocator, &freed] {
+            std::vector<double*> blocks;
+            for (size_t i = 0; i < BLOCK_COUNT; ++i) {
+                blocks.push_back(allocator.allocate(4));
+            }
+            for (double* p : blocks) {
+                allocator.deallocate(p, 4);
+                freed.insert(p);
+            }
+        }).join();
+
+        std::thread([&allocator, &freed] {
+            for (size_t i = 0; i < BLOCK_COUNT; ++i) {
+                ASSERT_TRUE_MSG(freed.count(allocator.allocate(4)) == 1, "Blocks freed by an exited thread are reused")
+            }
+        }).join();
+
+        // So does a thread that is still running.
+        double* p = allocator.allocate(8);
+        std::thread([&allocator, p] {
+            allocator.deallocate(p, 8);
+        }).join();
+        ASSERT_TRUE_MSG(allocator.allocate(8) == p, "Blocks freed by an exited thread are reused")
+    }
+
+
+    {
+        // One pool outlives the threads that used it, another dies first.
+        std::vector<int, ConcurrentChunkAllocator<int>> kept;
+        std::thread([&kept] {
+            ConcurrentChunkAllocator<int> allocator;
+            {
+                std::vector<int, ConcurrentChunkAllocator<int>> temporary(allocator);
+                for (int i = 0; i < 1000; ++i) {
+                    temporary.push_back(i);
+                }
+            }
+            kept = std::vector<int, ConcurrentChunkAllocator<int>>(10, 1);
+        }).join();
+        ASSERT_TRUE_MSG(kept.size() == 10 && kept.back() == 1, "ConcurrentChunkAllocator outliving its thread")
+        kept.push_back(2);
+    }
+
+
+    {
+        const size_t CHUNK_SIZE = 1 << 16;
+
+        CountingResource upstream;
+        MonotonicChunkResource resource(CHUNK_SIZE, &upstream);
+
+        for (size_t alignment = 1; alignment <= ChunkSizeClass::MAX_ALIGN; alignment *= 2) {
+            size_t bytes = RandomUInt(1, 1000);
+            void* p = resource.allocate(bytes, alignment);
+            ASSERT_TRUE_MSG(IsAligned(p, alignment), "MonotonicChunkResource alignment")
+            resource.deallocate(p, bytes, alignment);
+        }
+        ASSERT_TRUE_MSG(resource.getFragmentationReport().free_listed == 0, "MonotonicChunkResource never reuses blocks")
+        ASSERT_TRUE_MSG(ReportAddsUp(resource.getFragmentationReport()), "MonotonicChunkResource::getFragmentationReport")
+
+        // Over-aligned and oversized requests go to the upstream resource.
+        ASSERT_TRUE_MSG(upstream.allocations == 0, "MonotonicChunkResource upstream")
+        void* over_aligned = resource.allocate(64, ChunkSizeClass::MAX_ALIGN * 2);
+        ASSERT_TRUE_MSG(IsAligned(over_aligned, ChunkSizeClass::MAX_ALIGN * 2), "MonotonicChunkResource over-aligned request")
+        void* oversized = resource.allocate(CHUNK_SIZE + 1);
+        ASSERT_TRUE_MSG(upstream.allocations == 2, "MonotonicChunkResource upstream")
+        resource.deallocate(over_aligned, 64, ChunkSizeClass::MAX_ALIGN * 2);
+        resource.deallocate(oversized, CHUNK_SIZE + 1);
+        ASSERT_TRUE_MSG(upstream.deallocations == 2, "MonotonicChunkResource upstream")
+
+        {
+            std::pmr::vector<size_t> vector(&resource);
+            RandomFill(vector, RandomUInt(1000, 5000));
+            ASSERT_TRUE_MSG(upstream.allocations == 2, "std::pmr::vector with MonotonicChunkResource")
+        }
+
+        resource.release();
+        ASSERT_TRUE_MSG(resource.getFragmentationReport().reserved == 0, "MonotonicChunkResource::release")
+    }
+
+
+    {
+        const size_t CHUNK_SIZE = 1 << 16;
+
+        CountingResource upstream;
+        PooledChunkResource resource(CHUNK_SIZE, &upstream);
+
+        for (size_t alignment = 1; alignment <= ChunkSizeClass::MAX_ALIGN; alignment *= 2) {
+            size_t bytes = RandomUInt(1, 1000);
+            void* p = resource.allocate(bytes, alignment);
+            ASSERT_TRUE_MSG(IsAligned(p, alignment), "PooledChunkResource alignment")
+            resource.deallocate(p, bytes, alignment);
+            ASSERT_TRUE_MSG(resource.allocate(bytes, alignment) == p, "PooledChunkResource reuses freed blocks")
+            resource.deallocate(p, bytes, alignment);
+        }
+        ASSERT_TRUE_MSG(resource.getFragmentationReport().in_use == 0, "PooledChunkResource::deallocate")
+        ASSERT_TRUE_MSG(ReportAddsUp(resource.getFragmentationReport()), "PooledChunkResource::getFragmentationReport")
+
+        // A 48-byte block serves any request rounding up to its class.
+        void* p = resource.allocate(48, 16);
+        resource.deallocate(p, 48, 16);
+        ASSERT_TRUE_MSG(resource.allocate(40, 8) == p, "PooledChunkResource reuses freed blocks")
+        resource.deallocate(p, 40, 8);
+
+        ASSERT_TRUE_MSG(upstream.allocations == 0, "PooledChunkResource upstream")
+        void* over_aligned = resource.allocate(64, ChunkSizeClass::MAX_ALIGN * 2);
+        ASSERT_TRUE_MSG(IsAligned(over_aligned, ChunkSizeClass::MAX_ALIGN * 2), "PooledChunkResource over-aligned request")
+        void* oversized = resource.allocate(CHUNK_SIZE + 1);
+        ASSERT_TRUE_MSG(upstream.allocations == 2, "PooledChunkResource upstream")
+        auto report = resource.getFragmentationReport();
+        resource.deallocate(over_aligned, 64, ChunkSizeClass::MAX_ALIGN * 2);
+        resource.deallocate(oversized, CHUNK_SIZE + 1);
+        ASSERT_TRUE_MSG(upstream.deallocations == 2, "PooledChunkResource upstream")
+        ASSERT_TRUE_MSG(resource.getFragmentationReport().free_listed == report.free_listed, "PooledChunkResource upstream")
+
+        std::pmr::unordered_map<size_t, size_t> map_chunk(&resource);
+        std::unordered_map<size_t, size_t> map_std;
+        for (size_t iter = 0; iter < 10000; ++iter) {
+            size_t key = RandomUInt(1000);
+            if (TossCoin()) {
+                map_chunk[key] = iter;
+                map_std[key] = iter;
+            } else {
+                map_chunk.erase(key);
+                map_std.erase(key);
+            }
+        }
+        ASSERT_TRUE_MSG(map_chunk.size() == map_std.size(), "std::pmr::unordered_map with PooledChunkResource")
+        for (auto [key, value] : map_std) {
+            ASSERT_TRUE_MSG(map_chunk.at(key) == value, "std::pmr::unordered_map with PooledChunkResource")
+        }
+        ASSERT_TRUE_MSG(upstream.allocations == 2, "std::pmr::unordered_map with PooledChunkResource")
+    }
+
+
+    {
+        // Chunk sizes are in bytes.
+        ChunkAllocator<double> allocator(4096);
+        double* p = allocator.allocate(4096 / sizeof(double));
+        std::fill(p, p + 4096 / sizeof(double), 1.);
+        ASSERT_TRUE_MSG(allocator.getFragmentationReport().reserved == 4096, "ChunkAllocator chunk size in bytes")
+
+        bool thrown = false;
+        try {
+            allocator.allocate(4096 / sizeof(double) + 1);
+        } catch (const std::bad_alloc&) {
+            thrown = true;
+        }
+        ASSERT_TRUE_MSG(thrown, "ChunkAllocator rejects blocks larger than a chunk")
+        ASSERT_TRUE_MSG(allocator.getFragmentationReport().reserved == 4096, "ChunkAllocator chunk size in bytes")
+    }
+
+
+    {
+        ChunkAllocator<SimdBlock> allocator(1 << 16);
+        std::vector<std::pair<SimdBlock*, size_t>> blocks;
+        for (size_t iter = 0; iter < 1000; ++iter) {
+            size_t n = RandomUInt(1, 20);
+            SimdBlock* p = allocator.allocate(n);
+            ASSERT_TRUE_MSG(IsAligned(p, alignof(SimdBlock)), "ChunkAllocator over-aligned type")
+            blocks.emplace_back(p, n);
+            // Interleave small requests of other types to shift the bump
+            // pointer off alignment.
+            ChunkAllocator<char>(allocator).allocate(RandomUInt(1, 100));
+        }
+        for (auto [p, n] : blocks) {
+            allocator.deallocate(p, n);
+        }
+
+        // A freed 64-byte block is handed out for eight doubles, and a block
+        // freed as doubles comes back aligned for SimdBlock.
+        ChunkAllocator<double> doubles(allocator);
+        SimdBlock* p = allocator.allocate(1);
+        allocator.deallocate(p, 1);
+        double* q = doubles.allocate(8);
+        ASSERT_TRUE_MSG(static_cast<void*>(q) == p, "Freed block is reused by a different type")
+        doubles.deallocate(q, 8);
+        ASSERT_TRUE_MSG(static_cast<void*>(allocator.allocate(1)) == q, "Freed block is reused by a different type")
+
+        std::vector<SimdBlock, ChunkAllocator<SimdBlock>> vector(allocator);
+        for (size_t i = 0; i < 100; ++i) {
+            vector.push_back(SimdBlock{{static_cast<double>(i)}});
+            ASSERT_TRUE_MSG(IsAligned(vector.data(), alignof(SimdBlock)), "std::vector of an over-aligned type")
+        }
+        ASSERT_TRUE_MSG(vector[99].values[0] == 99., "std::vector of an over-aligned type")
+
+        ConcurrentChunkAllocator<SimdBlock> concurrent(1 << 16);
+        for (size_t iter = 0; iter < 1000; ++iter) {
+            size_t n = RandomUInt(1, 20);
+            SimdBlock* p = concurrent.allocate(n);
+            ASSERT_TRUE_MSG(IsAligned(p, alignof(SimdBlock)), "ConcurrentChunkAllocator over-aligned type")
+            if (TossCoin()) {
+                concurrent.deallocate(p, n);
+            }
+        }
+    }
+
+
+    {
+        ChunkPolicy policy;
+        policy.growth = 2;
+        policy.max_chunk_size = 16384;
+        ASSERT_TRUE_MSG(policy.chunkSize(4096, 0) == 4096 && policy.chunkSize(4096, 1) == 8192, "ChunkPolicy::chunkSize")
+        ASSERT_TRUE_MSG(policy.chunkSize(4096, 2) == 16384 && policy.chunkSize(4096, 10) == 16384, "ChunkPolicy::chunkSize")
+
+        // Chunks of 4096, 8192, 16384 and 16384 bytes hold 1, 2, 4 and 4
+        // blocks of a whole first chunk.
+        ChunkAllocator<char> allocator(4096, policy);
+        for (size_t i = 0; i < 11; ++i) {
+            char* p = allocator.allocate(4096);
+            std::fill(p, p + 4096, static_cast<char>(i));
+        }
+        ASSERT_TRUE_MSG(allocator.getFragmentationReport().reserved == 4096 + 8192 + 2 * 16384, "Growing chunks")
+        ASSERT_TRUE_MSG(allocator.getFragmentationReport().untouched == 0, "Growing chunks")
+
+        // Requests are still limited by the first chunk size.
+        bool thrown = false;
+        try {
+            allocator.allocate(4097);
+        } catch (const std::bad_alloc&) {
+            thrown = true;
+        }
+        ASSERT_TRUE_MSG(thrown, "Growing chunks do not allow larger requests")
+    }
+
+
+    {
+        const size_t PAGE_SIZE = sysconf(_SC_PAGESIZE);
+
+        ChunkPolicy policy;
+        policy.mmap = true;
+        ChunkAllocator<int> allocator(1000, policy);
+        int* p = allocator.allocate(250);
+        std::fill(p, p + 250, 1);
+        ASSERT_TRUE_MSG(IsAligned(p, PAGE_SIZE), "Mapped chunks are page-aligned")
+        auto report = allocator.getFragmentationReport();
+        ASSERT_TRUE_MSG(report.reserved == PAGE_SIZE, "Mapped chunks are rounded up to whole pages")
+        ASSERT_TRUE_MSG(ReportAddsUp(report), "ChunkAllocator::getFragmentationReport")
+
+        policy = ChunkPolicy();
+        policy.huge_pages = true;
+        policy.populate = true;
+        ChunkAllocator<double> huge(4096, policy);
+        double* q = huge.allocate(512);
+        ASSERT_TRUE_MSG(IsResident(q, ChunkPolicy::hugePageSize()), "Huge-page chunks are populated")
+        std::fill(q, q + 512, 1.);
+        ASSERT_TRUE_MSG(IsAligned(q, ChunkPolicy::hugePageSize()), "Huge-page chunks are huge-page-aligned")
+        ASSERT_TRUE_MSG(huge.getFragmentationReport().reserved == ChunkPolicy::hugePageSize(),
+                        "Huge-page chunks are rounded up to whole huge pages")
+
+        ConcurrentChunkAllocator<size_t> concurrent(1 << 16, policy);
+        std::vector<size_t, ConcurrentChunkAllocator<size_t>> vector(concurrent);
+        RandomFill(vector, 1000);
+        ASSERT_TRUE_MSG(IsAligned(vector.data(), alignof(size_t)), "ConcurrentChunkAllocator with mapped chunks")
+
+        PooledChunkResource resource(1 << 16, policy);
+        std::pmr::vector<size_t> pmr_vector(&resource);
+        RandomFill(pmr_vector, 1000);
+        ASSERT_TRUE_MSG(resource.getFragmentationReport().reserved == ChunkPolicy::hugePageSize(),
+                        "PooledChunkResource with huge-page chunks")
+    }
+
+
+    {
+        // A chunk holds a slab of task::list nodes and the bucket array of
+        // the unordered_map.
+        const size_t COUNT = 200;
+
+        ChunkAllocator<int> allocator(1 << 16);
+        {
+            std::map<int, int, std::less<int>, ChunkAllocator<std::pair<const int, int>>> map(allocator);
+            std::list<int, ChunkAllocator<int>> list_std(allocator);
+            task::list<int, ChunkAllocator<int>> list_task(allocator);
+            std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+                               ChunkAllocator<std::pair<const int, int>>> unordered_map(0, std::hash<int>(), std::equal_to<int>(), allocator);
+
+            size_t in_use = 0;
+            auto grew = [&allocator, &in_use] {
+                size_t now = allocator.getFragmentationReport().in_use;
+                bool result = now > in_use;
+                in_use = now;
+                return result;
+            };
+            for (size_t i = 0; i < COUNT; ++i) {
+                map[i] = i;
+            }
+            ASSERT_TRUE_MSG(grew(), "std::map nodes come from the shared arena")
+            for (size_t i = 0; i < COUNT; ++i) {
+                list_std.push_back(i);
+            }
+            ASSERT_TRUE_MSG(grew(), "std::list nodes come from the shared arena")
+            for (size_t i = 0; i < COUNT; ++i) {
+                list_task.push_back(i);
+            }
+            ASSERT_TRUE_MSG(grew(), "task::list nodes come from the shared arena")
+            for (size_t i = 0; i < COUNT; ++i) {
+                unordered_map[i] = i;
+            }
+            ASSERT_TRUE_MSG(grew(), "std::unordered_map nodes come from the shared arena")
+
+            ASSERT_TRUE_MSG(map.get_allocator() == allocator, "Rebound copies share the arena")
+            ASSERT_TRUE_MSG(list_task.get_allocator() == allocator, "Rebound copies share the arena")
+            ASSERT_TRUE_MSG(unordered_map.get_allocator() == allocator, "Rebound copies share the arena")
+
+            // Copies and bulk construction draw from the same arena.
+            auto list_copy = list_task;
+            task::list<int, ChunkAllocator<int>> list_bulk(list_std.begin(), list_std.end(), allocator);
+            ASSERT_EQUAL_MSG(list_copy, list_std, "task::list copy with ChunkAllocator")
+            ASSERT_EQUAL_MSG(list_bulk, list_std, "task::list bulk construction with ChunkAllocator")
+            ASSERT_TRUE_MSG(grew(), "task::list copies come from the shared arena")
+
+            // Nodes freed by one container are reused by another.
+            size_t reserved = allocator.getFragmentationReport().reserved;
+            list_std.clear();
+            for (size_t i = 0; i < COUNT; ++i) {
+                list_copy.push_front(i);
+            }
+            ASSERT_TRUE_MSG(allocator.getFragmentationReport().reserved == reserved, "Containers share freed blocks")
+        }
+
+        auto report = allocator.getFragmentationReport();
+        ASSERT_TRUE_MSG(report.in_use == 0, "Every container freed its nodes into the shared arena")
+        ASSERT_TRUE_MSG(ReportAddsUp(report), "ChunkAllocator::getFragmentationReport")
+    }
+
+
+    {
+        ChunkAllocator<char> allocator(4096);
+        std::stringstream trace;
+        std::vector<ChunkTraceEvent> expected;
+
+        allocator.startTrace(trace);
+        std::vector<std::pair<char*, size_t>> blocks;
+        for (size_t iter = 0; iter < 10000; ++iter) {
+            if (blocks.empty() || TossCoin()) {
+                size_t n = RandomUInt(1, 4096);
+                char* p = allocator.allocate(n);
+                blocks.emplace_back(p, n);
+                expected.push_back({ChunkTraceEvent::ALLOCATE, n, reinterpret_cast<uintptr_t>(p), 0});
+            } else {
+                size_t i = RandomUInt(blocks.size() - 1);
+                auto [p, n] = blocks[i];
+                allocator.deallocate(p, n);
+                blocks[i] = blocks.back();
+                blocks.pop_back();
+                expected.push_back({ChunkTraceEvent::DEALLOCATE, n, reinterpret_cast<uintptr_t>(p), 0});
+            }
+        }
+        allocator.stopTrace();
+        // Not traced any more.
+        allocator.deallocate(allocator.allocate(1), 1);
+
+        ChunkTraceReader reader(trace);
+        ASSERT_TRUE_MSG(reader.good() && reader.getChunkSize() == 4096, "ChunkTraceReader header")
+        ChunkTraceEvent event;
+        for (const auto& item : expected) {
+            ASSERT_TRUE_MSG(reader.next(event), "ChunkTraceReader::next")
+            ASSERT_TRUE_MSG(event.kind == item.kind && event.bytes == item.bytes && event.address == item.address,
+                            "Trace round trip")
+        }
+        ASSERT_TRUE_MSG(!reader.next(event) && reader.good(), "Trace round trip")
+
+        // Cut inside the last event.
+        std::string bytes = trace.str();
+        std::stringstream truncated(bytes.substr(0, bytes.size() - 1));
+        ChunkTraceReader truncated_reader(truncated);
+        for (size_t i = 0; i + 1 < expected.size(); ++i) {
+            ASSERT_TRUE_MSG(truncated_reader.next(event), "Truncated trace")
+        }
+        ASSERT_TRUE_MSG(!truncated_reader.next(event) && !truncated_reader.good(), "Truncated trace")
+
+        std::stringstream garbage("CHTX garbage");
+        ASSERT_TRUE_MSG(!ChunkTraceReader(garbage).good(), "ChunkTraceReader header")
+    }
+
+
+    {
+        MonotonicChunkResource resource(4096);
+        std::stringstream trace;
+
+        resource.startTrace(trace);
+        void* p = resource.allocate(100, 64);
+        void* q = resource.allocate(3, 1);
+        resource.release();
+        resource.stopTrace();
+
+        ChunkTraceReader reader(trace);
+        ChunkTraceEvent event;
+        ASSERT_TRUE_MSG(reader.next(event), "Trace of a monotonic resource")
+        ASSERT_TRUE_MSG(event.kind == ChunkTraceEvent::ALLOCATE_MONOTONIC && event.bytes == 100 &&
+                        event.alignment == 64 && event.address == reinterpret_cast<uintptr_t>(p),
+                        "Trace of a monotonic resource")
+        ASSERT_TRUE_MSG(reader.next(event), "Trace of a monotonic resource")
+        ASSERT_TRUE_MSG(event.kind == ChunkTraceEvent::ALLOCATE_MONOTONIC && event.bytes == 3 &&
+                        event.alignment == 1 && event.address == reinterpret_cast<uintptr_t>(q),
+                        "Trace of a monotonic resource")
+        ASSERT_TRUE_MSG(reader.next(event) && event.kind == ChunkTraceEvent::CLEAR, "Trace of a monotonic resource")
+        ASSERT_TRUE_MSG(!reader.next(event), "Trace of a monotonic resource")
+    }
+
+
+    {
+        ChunkAllocator<char> allocator(4096);
+        char* before = allocator.allocate(100);
+
+        auto statistics = allocator.getStatistics();
+        ASSERT_TRUE_MSG(!statistics.enabled && statistics.allocations == 0, "Statistics are opt-in")
+        ASSERT_TRUE_MSG(statistics.in_use == 112 && statistics.chunks == 1, "Byte totals are always kept")
+
+        allocator.enableStatistics();
+        std::vector<char*> blocks;
+        for (size_t i = 0; i < 10; ++i) {
+            blocks.push_back(allocator.allocate(24));
+        }
+        for (char* p : blocks) {
+            allocator.deallocate(p, 24);
+        }
+        // Half of these come from the free list.
+        for (size_t i = 0; i < 20; ++i) {
+            blocks.push_back(allocator.allocate(20));
+        }
+        allocator.deallocate(before, 100);
+
+        statistics = allocator.getStatistics();
+        auto report = allocator.getFragmentationReport();
+        ASSERT_TRUE_MSG(statistics.enabled, "ChunkStatistics::enabled")
+        ASSERT_TRUE_MSG(statistics.allocations == 30, "ChunkStatistics::allocations")
+        ASSERT_TRUE_MSG(statistics.deallocations == 11, "ChunkStatistics::deallocations")
+        ASSERT_TRUE_MSG(statistics.free_list_hits == 10, "ChunkStatistics::free_list_hits")
+        ASSERT_TRUE_MSG(statistics.freeListHitRate() == 1. / 3, "ChunkStatistics::freeListHitRate")
+        ASSERT_TRUE_MSG(statistics.allocations_by_class[ChunkSizeClass::index(24)] == 30, "ChunkStatistics::allocations_by_class")
+        ASSERT_TRUE_MSG(statistics.allocations_by_class[ChunkSizeClass::index(100)] == 0, "ChunkStatistics::allocations_by_class")
+        ASSERT_TRUE_MSG(statistics.peak_in_use == 112 + 20 * 32, "ChunkStatistics::peak_in_use")
+        ASSERT_TRUE_MSG(statistics.in_use == 20 * 32 && statistics.in_use == report.in_use, "ChunkStatistics::in_use")
+        ASSERT_TRUE_MSG(statistics.reserved == report.reserved && statistics.chunks == 1, "ChunkStatistics::reserved")
+        ASSERT_TRUE_MSG(statistics.wasted == 20 * (32 - 20) + report.abandoned, "ChunkStatistics::wasted")
+
+        // A request that does not fit the rest of the chunk starts another
+        // one and abandons the tail.
+        allocator.allocate(4000);
+        statistics = allocator.getStatistics();
+        report = allocator.getFragmentationReport();
+        ASSERT_TRUE_MSG(statistics.chunks == 2 && statistics.reserved == report.reserved, "ChunkStatistics::chunks")
+        ASSERT_TRUE_MSG(report.abandoned > 0, "ChunkArena::FragmentationReport::abandoned")
+        ASSERT_TRUE_MSG(statistics.wasted == report.in_use - report.requested + report.abandoned, "ChunkStatistics::wasted")
+        ASSERT_TRUE_MSG(statistics.peak_in_use == report.in_use, "ChunkStatistics::peak_in_use")
+        ASSERT_TRUE_MSG(ReportAddsUp(report), "ChunkAllocator::getFragmentationReport")
+    }
+
+}
@@ -0,0 +1,11 @@
+#!/bin/bash
+
+set -e
+
+g++ -std=c++17 -O2 -I./ bench/list_bench.cpp -o list_bench
+./list_bench
+
+g++ -std=c++17 -O2 -pthread -I./ bench/queue_bench.cpp -o queue_bench
+./queue_bench
+
+rm list_bench queue_bench
@@ -0,0 +1,355 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <random>
+#include <vector>
+#include "src/list.h"
+
+
+// Every operation is measured this many times on a fresh container and the
+// fastest run is reported.
+const size_t REPEATS = 3;
+
+volatile size_t sink;
+
+
+// Element of the given size; only the first word takes part in comparisons.
+template <size_t Bytes>
+struct Payload {
+    static_assert(Bytes >= 4 && Bytes % 4 == 0, "Payload size must be a multiple of 4");
+
+    explicit Payload(uint32_t key = 0) : words{} {
+        words[0] = key;
+    }
+
+    uint32_t key() const {
+        return words[0];
+    }
+
+    bool operator<(const Payload& other) const {
+        return key() < other.key();
+    }
+    bool operator==(const Payload& other) const {
+        return key() == other.key();
+    }
+
+    std::array<uint32_t, Bytes / 4> words;
+};
+
+
+// Allocator hook: every container below allocates through it, so each
+// measurement also reports how many allocator calls it made.
+struct AllocStats {
+    size_t calls = 0;
+    size_t bytes = 0;
+};
+
+AllocStats alloc_stats;
+
+template <class T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template <class U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        ++alloc_stats.calls;
+        alloc_stats.bytes += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    bool operator==(const CountingAllocator&) const {
+        return true;
+    }
+    bool operator!=(const CountingAllocator&) const {
+        return false;
+    }
+};
+
+
+struct Result {
+    double ns_per_element = 0.;
+    double allocs_per_element = 0.;
+    double bytes_per_element = 0.;
+};
+
+// Passed to every measured operation, which does its setup first and then
+// brackets the measured part with Start() and Stop().
+class Stopwatch {
+public:
+    void Start() {
+        stats_ = alloc_stats;
+        start_ = std::chrono::steady_clock::now();
+    }
+
+    void Stop() {
+        elapsed_ = std::chrono::steady_clock::now() - start_;
+        calls_ = alloc_stats.calls - stats_.calls;
+        bytes_ = alloc_stats.bytes - stats_.bytes;
+    }
+
+    Result PerElement(size_t elements) const {
+        Result result;
+        result.ns_per_element = elapsed_.count() * 1e9 / elements;
+        result.allocs_per_element = static_cast<double>(calls_) / elements;
+        result.bytes_per_element = static_cast<double>(bytes_) / elements;
+        return result;
+    }
+
+private:
+    AllocStats stats_;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::duration<double> elapsed_{};
+    size_t calls_ = 0;
+    size_t bytes_ = 0;
+};
+
+template <class F>
+Result Measure(size_t elements, F f) {
+    Result best;
+    for (size_t i = 0; i < REPEATS; ++i) {
+        Stopwatch watch;
+        f(watch);
+        Result result = watch.PerElement(elements);
+        if (i == 0 || result.ns_per_element < best.ns_per_element) {
+            best = result;
+        }
+    }
+    return best;
+}
+
+
+// std::deque has no list operations; these overloads emulate them with the
+// algorithms a deque user would reach for.
+template <class C>
+void Sort(C& c) {
+    c.sort();
+}
+template <class T, class A>
+void Sort(std::deque<T, A>& c) {
+    std::stable_sort(c.begin(), c.end());
+}
+
+template <class C>
+void Merge(C& c, C& other) {
+    c.merge(other);
+}
+template <class T, class A>
+void Merge(std::deque<T, A>& c, std::deque<T, A>& other) {
+    size_t middle = c.size();
+    c.insert(c.end(), other.begin(), other.end());
+    other.clear();
+    std::inplace_merge(c.begin(), c.begin() + middle, c.end());
+}
+
+template <class C>
+void Unique(C& c) {
+    c.unique();
+}
+template <class T, class A>
+void Unique(std::deque<T, A>& c) {
+    c.erase(std::unique(c.begin(), c.end()), c.end());
+}
+
+template <class C>
+void Reverse(C& c) {
+    c.reverse();
+}
+template <class T, class A>
+void Reverse(std::deque<T, A>& c) {
+    std::reverse(c.begin(), c.end());
+}
+
+// Moves count elements from the front of other to before pos.
+template <class C>
+void SpliceFront(C& c, typename C::iterator pos, C& other, size_t count) {
+    c.splice(pos, other, other.begin(), std::next(other.begin(), count));
+}
+template <class T, class A>
+void SpliceFront(std::deque<T, A>& c, typename std::deque<T, A>::iterator pos,
+                 std::deque<T, A>& other, size_t count) {
+    c.insert(pos, other.begin(), other.begin() + count);
+    other.erase(other.begin(), other.begin() + count);
+}
+
+
+const char* const OPERATIONS[] = {
+    "push_back", "pop_back", "push_front", "pop_front", "insert middle", "erase middle",
+    "iterate", "sort", "merge", "splice", "unique", "reverse",
+};
+const size_t OPERATION_COUNT = std::size(OPERATIONS);
+
+template <class C>
+C Filled(size_t n, uint32_t seed) {
+    std::mt19937 rand(seed);
+    C c;
+    for (size_t i = 0; i < n; ++i) {
+        c.emplace_back(static_cast<uint32_t>(rand()));
+    }
+    return c;
+}
+
+template <class C>
+C SortedFilled(size_t n, uint32_t seed) {
+    C c = Filled<C>(n, seed);
+    Sort(c);
+    return c;
+}
+
+// Results of all OPERATIONS, in order, for container C with n elements.
+template <class C>
+std::vector<Result> RunAll(size_t n) {
+    using value_type = typename C::value_type;
+    // Operations in the middle of a deque are linear; keep their count low.
+    size_t middle_ops = std::min<size_t>(n / 4, 1024);
+    size_t splice_chunk = 256;
+    std::vector<Result> results;
+
+    results.push_back(Measure(n, [&](Stopwatch& watch) {
+        C c;
+        watch.Start();
+        for (size_t i = 0; i < n; ++i) {
+            c.push_back(value_type(i));
+        }
+        watch.Stop();
+    }));
+    results.push_back(Measure(n, [&](Stopwatch& watch) {
+        C c = Filled<C>(n, 1);
+        watch.Start();
+        for (size_t i = 0; i < n; ++i) {
+            c.pop_back();
+        }
+        watch.Stop();
+    }));
+    results.push_back(Measure(n, [&](Stopwatch& watch) {
+        C c;
+        watch.Start();
+        for (size_t i = 0; i < n; ++i) {
+            c.push_front(value_type(i));
+        }
+        watch.Stop();
+    }));
+    results.push_back(Measure(n, [&](Stopwatch& watch) {
+        C c = Filled<C>(n, 1);
+        watch.Start();
+        for (size_t i = 0; i < n; ++i) {
+            c.pop_front();
+        }
+        watch.Stop();
+    }));
+    results.push_back(Measure(middle_ops, [&](Stopwatch& watch) {
+        C c = Filled<C>(n, 1);
+        auto it = std::next(c.begin(), n / 2);
+        watch.Start();
+        for (size_t i = 0; i < middle_ops; ++i) {
+            it = c.insert(it, value_type(i));
+        }
+        watch.Stop();
+    }));
+    results.push_back(Measure(middle_ops, [&](Stopwatch& watch) {
+        C c = Filled<C>(n, 1);
+        auto it = std::next(c.begin(), n / 4);
+        watch.Start();
+        for (size_t i = 0; i < middle_ops; ++i) {
+            it = c.erase(it);
+        }
+        watch.Stop();
+    }));
+    results.push_back(Measure(n, [&](Stopwatch& watch) {
+        C c = Filled<C>(n, 1);
+        watch.Start();
+        size_t sum = 0;
+        for (const auto& item : c) {
+            sum += item.key();
+        }
+        watch.Stop();
+        sink = sum;
+    }));
+    results.push_back(Measure(n, [&](Stopwatch& watch) {
+        C c = Filled<C>(n, 1);
+        watch.Start();
+        Sort(c);
+        watch.Stop();
+    }));
+    results.push_back(Measure(n, [&](Stopwatch& watch) {
+        C c = SortedFilled<C>(n / 2, 1);
+        C other = SortedFilled<C>(n - n / 2, 2);
+        watch.Start();
+        Merge(c, other);
+        watch.Stop();
+    }));
+    results.push_back(Measure(n / 2, [&](Stopwatch& watch) {
+        C c = Filled<C>(n / 2, 1);
+        C other = Filled<C>(n / 2, 2);
+        watch.Start();
+        while (other.size() >= splice_chunk) {
+            SpliceFront(c, std::next(c.begin(), splice_chunk), other, splice_chunk);
+        }
+        watch.Stop();
+    }));
+    results.push_back(Measure(n, [&](Stopwatch& watch) {
+        C c;
+        for (size_t i = 0; i < n; ++i) {
+            c.push_back(value_type(i / 4));
+        }
+        watch.Start();
+        Unique(c);
+        watch.Stop();
+    }));
+    results.push_back(Measure(n, [&](Stopwatch& watch) {
+        C c = Filled<C>(n, 1);
+        watch.Start();
+        Reverse(c);
+        watch.Stop();
+    }));
+
+    return results;
+}
+
+
+template <size_t Bytes>
+void BenchSize(size_t n) {
+    using P = Payload<Bytes>;
+    auto task_list = RunAll<task::list<P, CountingAllocator<P>>>(n);
+    auto std_list = RunAll<std::list<P, CountingAllocator<P>>>(n);
+    auto std_deque = RunAll<std::deque<P, CountingAllocator<P>>>(n);
+
+    for (size_t op = 0; op < OPERATION_COUNT; ++op) {
+        std::printf("%-14s %5zu", OPERATIONS[op], Bytes);
+        for (const auto* results : {&task_list, &std_list, &std_deque}) {
+            const Result& r = (*results)[op];
+            std::printf(" %9.1f ns %6.2f al %7.1f B", r.ns_per_element,
+                        r.allocs_per_element, r.bytes_per_element);
+        }
+        std::printf("\n");
+    }
+    std::printf("\n");
+}
+
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1 << 16;
+
+    // Per element: time, allocator calls and bytes requested from the
+    // allocator during the measured part.
+    std::printf("%zu elements per container\n", n);
+    std::printf("%-14s %5s %-32s %-32s %-32s\n", "operation", "bytes", "task::list", "std::list",
+                "std::deque");
+    BenchSize<4>(n);
+    BenchSize<16>(n);
+    BenchSize<64>(n);
+    BenchSize<256>(n);
+}
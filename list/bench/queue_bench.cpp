@@ -0,0 +1,87 @@
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "src/list.h"
+#include "src/mpsc_queue.h"
+
+
+// Items pushed in every run, split evenly between the producers.
+const size_t ITEM_COUNT = 1 << 22;
+
+volatile size_t sink;
+
+
+class MutexQueue {
+public:
+    void push(size_t value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        list_.push_back(value);
+    }
+
+    bool try_pop(size_t& value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (list_.empty()) {
+            return false;
+        }
+        value = list_.front();
+        list_.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    task::list<size_t> list_;
+};
+
+
+// Runs producers pushing ITEM_COUNT items in total against one consumer
+// and returns millions of items per second.
+template <class Queue>
+double Run(size_t producers) {
+    Queue queue;
+    size_t per_producer = ITEM_COUNT / producers;
+    size_t total = per_producer * producers;
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, per_producer] {
+            for (size_t i = 0; i < per_producer; ++i) {
+                queue.push(i);
+            }
+        });
+    }
+
+    size_t popped = 0;
+    size_t sum = 0;
+    size_t value;
+    while (popped < total) {
+        if (queue.try_pop(value)) {
+            sum += value;
+            ++popped;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    sink = sum;
+    return total / elapsed.count() / 1e6;
+}
+
+
+int main() {
+    std::printf("%10s %22s %22s\n", "producers", "mutex + task::list", "mpsc_queue");
+    for (size_t producers = 1; producers <= 64; producers *= 2) {
+        double locked = Run<MutexQueue>(producers);
+        double lock_free = Run<task::mpsc_queue<size_t>>(producers);
+        std::printf("%10zu %16.2f Mop/s %16.2f Mop/s\n", producers, locked, lock_free);
+    }
+}
@@ -2,7 +2,16 @@
 
 set -e
 
-g++ -std=c++17 -I./ test/test.cpp -o list_test
+g++ -std=c++17 -pthread -I./ test/test.cpp -o list_test
 ./list_test
 
+g++ -std=c++17 -I./ test/unrolled_list_test.cpp -o unrolled_list_test
+./unrolled_list_test
+
+g++ -std=c++17 -I./ test/intrusive_list_test.cpp -o intrusive_list_test
+./intrusive_list_test
+
+g++ -std=c++17 -pthread -I./ test/mpsc_queue_test.cpp -o mpsc_queue_test
+./mpsc_queue_test
+
 echo All tests passed!
\ No newline at end of file
@@ -0,0 +1,254 @@
+#pragma once
+#include <iterator>
+#include <utility>
+
+namespace task {
+
+// Base class that embeds the links of an intrusive_list into a user object.
+// An object can be in several lists at once by deriving from several hooks
+// with different tags. A linked object can unlink itself in O(1) without
+// knowing its list, and does so automatically when destroyed.
+template <class Tag = void>
+class intrusive_list_hook {
+  template <class T, class ListTag>
+  friend class intrusive_list;
+
+ public:
+  intrusive_list_hook() : prev(nullptr), next(nullptr) {}
+
+  // Copies of an object start unlinked; links are never shared.
+  intrusive_list_hook(const intrusive_list_hook&) : intrusive_list_hook() {}
+  intrusive_list_hook& operator=(const intrusive_list_hook&) { return *this; }
+
+  ~intrusive_list_hook() { unlink(); }
+
+  bool is_linked() const { return next != nullptr; }
+
+  void unlink() {
+    if (next) {
+      prev->next = next;
+      next->prev = prev;
+      prev = next = nullptr;
+    }
+  }
+
+ private:
+  intrusive_list_hook* prev;
+  intrusive_list_hook* next;
+
+  void link_before(intrusive_list_hook* pos) {
+    prev = pos->prev;
+    next = pos;
+    pos->prev->next = this;
+    pos->prev = this;
+  }
+};
+
+// Doubly linked list of objects that derive from intrusive_list_hook<Tag>.
+// The list never allocates or copies: it only links the objects passed to
+// it, which must outlive their membership and must not already be linked
+// through the same hook.
+//
+// Because objects may unlink themselves behind the list's back, size() walks
+// the list; empty() is O(1).
+template <class T, class Tag = void>
+class intrusive_list {
+  using hook = intrusive_list_hook<Tag>;
+
+  template <class Value, class Hook>
+  class basic_iterator {
+    friend class intrusive_list;
+
+   public:
+    using difference_type = ptrdiff_t;
+    using value_type = T;
+    using pointer = Value*;
+    using reference = Value&;
+    using iterator_category = std::bidirectional_iterator_tag;
+
+    basic_iterator() : cur(nullptr) {}
+    template <class OtherValue, class OtherHook>
+    basic_iterator(const basic_iterator<OtherValue, OtherHook>& other)
+        : cur(other.cur) {}
+
+    reference operator*() const { return static_cast<reference>(*cur); }
+    pointer operator->() const { return static_cast<pointer>(cur); }
+
+    basic_iterator& operator++() {
+      cur = cur->next;
+      return *this;
+    }
+    basic_iterator operator++(int) {
+      auto tmp = *this;
+      cur = cur->next;
+      return tmp;
+    }
+    basic_iterator& operator--() {
+      cur = cur->prev;
+      return *this;
+    }
+    basic_iterator operator--(int) {
+      auto tmp = *this;
+      cur = cur->prev;
+      return tmp;
+    }
+
+    bool operator==(const basic_iterator& other) const {
+      return cur == other.cur;
+    }
+    bool operator!=(const basic_iterator& other) const {
+      return cur != other.cur;
+    }
+
+   private:
+    template <class OtherValue, class OtherHook>
+    friend class basic_iterator;
+
+    explicit basic_iterator(Hook* cur) : cur(cur) {}
+
+    Hook* cur;
+  };
+
+ public:
+  using value_type = T;
+  using iterator = basic_iterator<T, hook>;
+  using const_iterator = basic_iterator<const T, const hook>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  intrusive_list() { root.prev = root.next = &root; }
+
+  intrusive_list(const intrusive_list&) = delete;
+  intrusive_list& operator=(const intrusive_list&) = delete;
+
+  intrusive_list(intrusive_list&& other) noexcept : intrusive_list() {
+    swap(other);
+  }
+  intrusive_list& operator=(intrusive_list&& other) noexcept {
+    clear();
+    swap(other);
+    return *this;
+  }
+
+  ~intrusive_list() { clear(); }
+
+  T& front() { return static_cast<T&>(*root.next); }
+  const T& front() const { return static_cast<const T&>(*root.next); }
+
+  T& back() { return static_cast<T&>(*root.prev); }
+  const T& back() const { return static_cast<const T&>(*root.prev); }
+
+  iterator begin() { return iterator(root.next); }
+  iterator end() { return iterator(&root); }
+  const_iterator begin() const { return cbegin(); }
+  const_iterator end() const { return cend(); }
+
+  const_iterator cbegin() const { return const_iterator(root.next); }
+  const_iterator cend() const { return const_iterator(&root); }
+
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+
+  const_reverse_iterator crbegin() const {
+    return const_reverse_iterator(cend());
+  }
+  const_reverse_iterator crend() const {
+    return const_reverse_iterator(cbegin());
+  }
+
+  bool empty() const { return root.next == &root; }
+  size_t size() const { return std::distance(cbegin(), cend()); }
+
+  // Unlinks every object; the objects themselves are left untouched.
+  void clear() {
+    while (!empty()) {
+      root.next->unlink();
+    }
+  }
+
+  iterator insert(const_iterator pos, T& value) {
+    hook& h = value;
+    h.link_before(const_cast<hook*>(pos.cur));
+    return iterator(&h);
+  }
+
+  iterator erase(const_iterator pos) {
+    hook* next = pos.cur->next;
+    const_cast<hook*>(pos.cur)->unlink();
+    return iterator(next);
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    while (first != last) {
+      first = erase(first);
+    }
+    return iterator(const_cast<hook*>(last.cur));
+  }
+
+  void push_back(T& value) { insert(cend(), value); }
+  void pop_back() { root.prev->unlink(); }
+
+  void push_front(T& value) { insert(cbegin(), value); }
+  void pop_front() { root.next->unlink(); }
+
+  // Iterator to an object that is linked into this list.
+  static iterator iterator_to(T& value) {
+    return iterator(static_cast<hook*>(&value));
+  }
+  static const_iterator iterator_to(const T& value) {
+    return const_iterator(static_cast<const hook*>(&value));
+  }
+
+  void swap(intrusive_list& other) noexcept {
+    hook* first = empty() ? nullptr : root.next;
+    hook* last = root.prev;
+    adopt(other.empty() ? nullptr : other.root.next, other.root.prev);
+    other.adopt(first, last);
+  }
+
+  // Moves all objects of other before pos in O(1).
+  void splice(const_iterator pos, intrusive_list& other) {
+    if (this == &other || other.empty()) {
+      return;
+    }
+
+    hook* at = const_cast<hook*>(pos.cur);
+    hook* first = other.root.next;
+    hook* last = other.root.prev;
+    other.root.prev = other.root.next = &other.root;
+
+    first->prev = at->prev;
+    last->next = at;
+    at->prev->next = first;
+    at->prev = last;
+  }
+
+  // Moves the object at it, which may belong to any list with the same tag,
+  // before pos in O(1).
+  void splice(const_iterator pos, const_iterator it) {
+    hook* moved = const_cast<hook*>(it.cur);
+    if (pos.cur == moved || pos.cur == moved->next) {
+      return;
+    }
+    moved->unlink();
+    moved->link_before(const_cast<hook*>(pos.cur));
+  }
+
+ private:
+  hook root;
+
+  // Makes the chain first..last the content of this list, or empties the
+  // list when first is null.
+  void adopt(hook* first, hook* last) {
+    if (!first) {
+      root.prev = root.next = &root;
+      return;
+    }
+    root.next = first;
+    root.prev = last;
+    first->prev = &root;
+    last->next = &root;
+  }
+};
+
+}  // namespace task
@@ -1,25 +1,51 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <initializer_list>
 #include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <thread>
+#include <type_traits>
 #include <utility>
 
 namespace task {
 
+// Execution policies for list::sort, named after std::execution. The
+// standard ones are not used because <execution> makes libstdc++ require
+// linking against TBB.
+namespace execution {
+struct sequenced_policy {};
+struct parallel_policy {};
+
+inline constexpr sequenced_policy seq{};
+inline constexpr parallel_policy par{};
+}  // namespace execution
+
 template <class T, class Alloc = std::allocator<T>>
 class list {
+  struct slab;
+
  public:
   struct node {
-    explicit node(T value, node* prev)
-        : value(value), prev(prev), next(nullptr) {}
-    explicit node(T&& value, node* prev) noexcept : node(prev) {
-      value.swap(this.value);
-    }
-    explicit node(node* prev) : prev(prev), next(nullptr) {}
+    // The payload is constructed in place from args; with no args it is
+    // value-initialized.
+    template <class... Args>
+    explicit node(node* prev, Args&&... args)
+        : prev(prev), value(std::forward<Args>(args)...), next(nullptr) {}
     struct node* prev;
     T value;
     struct node* next;
+    // Slab the node was carved from, or null if it was allocated alone.
+    slab* owner = nullptr;
   };
 
   class iterator {
+    friend class list;
+
    public:
     using difference_type = ptrdiff_t;
     using value_type = T;
@@ -27,53 +53,39 @@ class list {
     using reference = T&;
     using iterator_category = std::bidirectional_iterator_tag;
 
-    iterator() : cur(list::end_iter) {}
-    iterator(const iterator& other) : cur(other.cur) {}
-    iterator& operator=(const iterator& other) { cur = other.cur; }
+    iterator() : cur(nullptr), owner(nullptr) {}
+    iterator(const iterator& other) = default;
+    iterator& operator=(const iterator& other) = default;
     iterator& operator++() {
-      auto tmp = *this;
-      go_next();
-      return tmp;
+      cur = cur->next;
+      return *this;
     }
-    iterator operator++(int shift) {
+    iterator operator++(int) {
       auto tmp = *this;
-      for (int i = 0; i < shift; i++) {
-        go_next();
-      }
+      ++*this;
       return tmp;
     }
-    reference operator*() const { &(cur->data); }
-    pointer operator->() const { return cur; }
+    reference operator*() const { return cur->value; }
+    pointer operator->() const { return &cur->value; }
     iterator& operator--() {
-      auto tmp = *this;
-      go_prev();
-      return tmp;
+      cur = cur ? cur->prev : owner->tail;
+      return *this;
     }
     iterator operator--(int) {
       auto tmp = *this;
-      go_prev();
+      --*this;
       return tmp;
     }
     bool operator==(iterator other) const { return cur == other.cur; }
-    bool operator!=(iterator other) const { !(operator=(other)); }
+    bool operator!=(iterator other) const { return cur != other.cur; }
 
    private:
-    pointer cur;
+    // end() is represented by a null node; owner is needed to step back
+    // from it to the tail.
+    iterator(node* cur, const list* owner) : cur(cur), owner(owner) {}
 
-    void go_next() {
-      if (!cur || !cur->next || cur == list::end_iter) {
-        cur = list::end_iter;
-      } else {
-        cur = cur->next;
-      }
-    }
-    void go_prev() {
-      if (!cur || !cur->prev || cur == list::end_iter) {
-        cur = list::end_iter;
-      } else {
-        cur = cur->prev;
-      }
-    }
+    node* cur;
+    const list* owner;
   };
 
   class const_iterator {
@@ -81,64 +93,54 @@ class list {
 
    public:
     using difference_type = ptrdiff_t;
-    using const_value_type = const T;
-    using const_pointer = const T*;
-    using const_reference = const T&;
+    using value_type = T;
+    using pointer = const T*;
+    using reference = const T&;
     using iterator_category = std::bidirectional_iterator_tag;
 
-    const_iterator(const_pointer cur) : cur(cur) {}
-    const_iterator(const const_iterator& other) : cur(other.cur) {}
-    const_iterator& operator=(const const_iterator& other) { cur = other.cur; }
+    const_iterator() : cur(nullptr), owner(nullptr) {}
+    const_iterator(const iterator& other)
+        : cur(other.cur), owner(other.owner) {}
+    const_iterator(const const_iterator& other) = default;
+    const_iterator& operator=(const const_iterator& other) = default;
     const_iterator& operator++() {
-      auto tmp = *this;
-      go_next();
-      return tmp;
+      cur = cur->next;
+      return *this;
     }
-    const_iterator operator++(int shift) {
+    const_iterator operator++(int) {
       auto tmp = *this;
-      for (int i = 0; i < shift; i++) {
-        go_next();
-      }
+      ++*this;
       return tmp;
     }
-    const_reference operator*() const { &(cur->data); }
-    const T* operator->() const { return cur; }
+    reference operator*() const { return cur->value; }
+    pointer operator->() const { return &cur->value; }
     const_iterator& operator--() {
-      auto tmp = *this;
-      go_prev();
-      return tmp;
+      cur = cur ? cur->prev : owner->tail;
+      return *this;
     }
-    const_iterator operator--(int shift) {
+    const_iterator operator--(int) {
       auto tmp = *this;
-      for (int i = 0; i < shift; i++) {
-        go_next();
-      }
+      --*this;
       return tmp;
     }
     bool operator==(const_iterator other) const { return cur == other.cur; }
     bool operator!=(const_iterator other) const { return cur != other.cur; }
 
    private:
-    const_pointer cur;
-    void go_next() {
-      if (!cur || !cur->next || cur == list::end_iter) {
-        cur = list::end_iter;
-      } else {
-        cur = cur->next;
-      }
-    }
-    void go_prev() {
-      if (!cur || !cur->prev || cur == list::end_iter) {
-        cur = list::end_iter;
-      } else {
-        cur = cur->prev;
-      }
-    }
+    const_iterator(node* cur, const list* owner) : cur(cur), owner(owner) {}
+
+    node* cur;
+    const list* owner;
   };
 
   friend class iterator;
   friend class const_iterator;
 
+  using value_type = T;
+  using allocator_type = Alloc;
+  using size_type = size_t;
+  using reference = T&;
+  using const_reference = const T&;
   using reverse_iterator = std::reverse_iterator<iterator>;
   using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
@@ -147,15 +149,47 @@ class list {
       : head(nullptr), tail(nullptr), size_(0), allocator(alloc) {}
   list(size_t count, const T& value, const Alloc& alloc = Alloc());
   explicit list(size_t count, const Alloc& alloc = Alloc());
+  template <class InputIt,
+            class = std::enable_if_t<!std::is_integral<InputIt>::value>>
+  list(InputIt first, InputIt last, const Alloc& alloc = Alloc());
+  list(std::initializer_list<T> init, const Alloc& alloc = Alloc());
 
   ~list();
 
   list(const list& other);
-  list(list&& other) noexcept : list() { other.swap(*this); }
+  // The allocator moves along with the nodes. Move assignment and swap only
+  // exchange allocators whose traits ask for it: otherwise swap requires
+  // equal allocators, and move assignment between unequal ones moves the
+  // elements one by one.
+  list(list&& other) noexcept;
   list& operator=(const list& other);
   list& operator=(list&& other);
 
-  Alloc get_allocator() const { return allocator; }
+  // Bulk construction, range insertion and resize allocate the new nodes of
+  // a call in slabs of up to SLAB_MAX_NODES when the number of elements is
+  // known up front. A slab is released when the last of its nodes is
+  // destroyed, whichever list it has been spliced into by then, so a single
+  // surviving node keeps its whole slab allocated. Every node carries a
+  // pointer to its slab for that, one word more than a bare node.
+  //
+  // assign reuses the nodes the list already has, as copy assignment does,
+  // and only allocates or frees the difference in length.
+  void assign(size_t count, const T& value);
+  template <class InputIt,
+            class = std::enable_if_t<!std::is_integral<InputIt>::value>>
+  void assign(InputIt first, InputIt last);
+  void assign(std::initializer_list<T> init) {
+    assign(init.begin(), init.end());
+  }
+
+  Alloc get_allocator() const { return Alloc(allocator); }
+
+  // Up to limit erased nodes are kept by the list and reused by later
+  // insertions instead of going back to the allocator. Zero disables it.
+  void set_node_cache_limit(size_t limit);
+  size_t node_cache_size() const { return cached_count; }
+  // Returns all cached nodes to the allocator.
+  void shrink_node_cache();
 
   T& front() { return head->value; }
   const T& front() const { return head->value; }
@@ -163,121 +197,64 @@ class list {
   T& back() { return tail->value; }
   const T& back() const { return tail->value; }
 
-  iterator begin() { return iterator(head); }
-  iterator end() { return iterator(end_iter); }
+  iterator begin() { return iterator(head, this); }
+  iterator end() { return iterator(nullptr, this); }
+
+  const_iterator begin() const { return cbegin(); }
+  const_iterator end() const { return cend(); }
 
-  const_iterator cbegin() const { return const_iterator(head); }
-  const_iterator cend() const { return const_iterator(end_iter); }
+  const_iterator cbegin() const { return const_iterator(head, this); }
+  const_iterator cend() const { return const_iterator(nullptr, this); }
 
-  /*
-  reverse_iterator rbegin();
-  reverse_iterator rend();
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
 
-  const_reverse_iterator crbegin() const;
-  const_reverse_iterator crend() const;
-  */
+  const_reverse_iterator crbegin() const {
+    return const_reverse_iterator(cend());
+  }
+  const_reverse_iterator crend() const {
+    return const_reverse_iterator(cbegin());
+  }
 
   bool empty() const { return size_ == 0; };
   size_t size() const { return size_; };
-  size_t max_size() const {
-    return 100500;  // (memavail() - sizeof(list)) / sizeof(node);
-  };
+  size_t max_size() const { return node_traits::max_size(allocator); };
   void clear();
 
   // The container is extended by inserting new elements before the element at
   // the specified position.
   iterator insert(const_iterator pos, const T& value) {
-    auto cur = pos->cur;
-    size_++;
-    if (cur == head) {
-      push_front(value);
-      return iterator(head);
-    } else {
-      node* new_node = new (allocator) node(value, cur->prev);
-      new_node->next = cur;
-      new_node->prev = cur->prev;
-      cur->prev->next = new_node;
-      return iterator(new_node);
-    }
+    node* new_node = create_node(nullptr, value);
+    link_before(pos.cur, new_node);
+    return iterator(new_node, this);
   }
 
   iterator insert(const_iterator pos, T&& value) {
-    auto cur = pos->cur;
-    size_++;
-    if (cur == head) {
-      push_front(value);
-      return const_iterator(head);
-    } else {
-      node* new_node = new (allocator) node(std::forward<T>(value), cur->prev);
-      new_node->next = cur;
-      new_node->prev = cur->prev;
-      cur->prev->next = new_node;
-      return const_iterator(new_node);
-    }
+    node* new_node = create_node(nullptr, std::move(value));
+    link_before(pos.cur, new_node);
+    return iterator(new_node, this);
   }
 
-  iterator insert(const_iterator pos, size_t count, const T& value) {
-    auto cur = pos->cur;
-    auto cur_head = new (allocator) node(std::forward<T>(value), cur->prev);
-    size_ += count;
-    if (cur == head) {
-      for (int i = 0; i < count - 1; i++) {
-        push_front(value);
-      }
-      return iterator(cur->prev);
-    } else {
-      node* new_head = new (allocator) node(std::forward<T>(value), cur->prev);
-      cur->prev->next = new_head;
-      node* new_cur = new_head;
-      for (int i = 0; i < count - 1; i++) {
-        new_cur->next = new (allocator) node(std::forward<T>(value), new_cur);
-        new_cur = new_cur->next;
-      }
-      new_cur->next = cur;
-      new_cur->prev = cur->prev;
-      cur->prev = new_cur;
-      iterator(new_cur);
-    }
+  iterator insert(const_iterator pos, size_t count, const T& value);
+  template <class InputIt,
+            class = std::enable_if_t<!std::is_integral<InputIt>::value>>
+  iterator insert(const_iterator pos, InputIt first, InputIt last);
+  iterator insert(const_iterator pos, std::initializer_list<T> init) {
+    return insert(pos, init.begin(), init.end());
   }
 
   iterator erase(const_iterator pos) {
-    if (size_ == 0) {
-      // raise an exception
-    }
-    if (size_ == 1) {
-      pop_back();
-      return iterator(list::end_ptr);
-    }
-
-    auto cur = pos->cur;
-    size_--;
-    if (cur == head) {
-      pop_front();
-      return iterator(head);
-    } else if (cur == tail) {
-      pop_back();
-      return iterator(tail);
-    } else {
-      auto ret = cur->next;
-      cur->prev->next = cur->next;
-      cur->next->prev = cur->prev;
-      delete cur;
-      return iterator(ret);
-    }
+    node* next = pos.cur->next;
+    unlink(pos.cur);
+    destroy_node(pos.cur);
+    return iterator(next, this);
   }
 
   iterator erase(const_iterator first, const_iterator last) {
-    auto cur = first->cur;
-    auto last_elem = last->cur;
-    int count = 0;
-    while (cur != last_elem) {
-      auto tmp = cur->next;
-      erase(iterator(cur));
-      cur = tmp;
-      count++;
+    while (first != last) {
+      first = erase(first);
     }
-    size_ -= count;
-    return iterator(cur);
+    return iterator(last.cur, this);
   }
 
   void push_back(const T& value);
@@ -290,139 +267,359 @@ class list {
 
   template <class... Args>
   iterator emplace(const_iterator pos, Args&&... args) {
-    auto cur = pos->cur;
-    size_++;
-    if (cur == head) {
-      node* new_node = new (allocator) node(T(std::forward<Args>(args)...));
-      new_node->next = head;
-      new_node->prev = nullptr;
-      head = new_node;
-      return const_iterator(head);
-    } else {
-      node* new_node = new (allocator) node(T(std::forward<Args>(args)...));
-      new_node->next = cur;
-      new_node->prev = cur->prev;
-      cur->prev->next = new_node;
-      return const_iterator(new_node);
-    }
+    node* new_node = create_node(nullptr, std::forward<Args>(args)...);
+    link_before(pos.cur, new_node);
+    return iterator(new_node, this);
   }
 
   template <class... Args>
   void emplace_back(Args&&... args) {
-    node* new_node = new (allocator) node(T(std::forward<Args>(args)...));
-
-    if (head == nullptr) {
-      head = tail = new_node;
-    } else {
-      tail->next = new_node;
-      tail = new_node;
-      tail->next = nullptr;
-    }
-    size_++;
+    link_before(nullptr, create_node(nullptr, std::forward<Args>(args)...));
   }
 
   template <class... Args>
   void emplace_front(Args&&... args) {
-    node* new_node = new (allocator) node(T(std::forward<Args>(args)...));
-
-    if (head == nullptr) {
-      head = tail = new_node;
-    } else {
-      head->prev = new_node;
-      new_node->next = head;
-      head = new_node;
-    }
-    size_++;
+    link_before(head, create_node(nullptr, std::forward<Args>(args)...));
   }
 
   void resize(size_t count);
   void swap(list& other);
 
   void merge(list& other);
+  template <class Compare>
+  void merge(list& other, Compare comp);
+
+  // Splicing relinks nodes: iterators and references to the moved elements
+  // stay valid and now refer into this list. Both lists must use equal
+  // allocators.
   void splice(const_iterator pos, list& other);
-  void remove(const T& value);
+  void splice(const_iterator pos, list& other, const_iterator it);
+  void splice(const_iterator pos, list& other, const_iterator first,
+              const_iterator last);
+  // O(1) range splice for callers that already know distance(first, last).
+  void splice(const_iterator pos, list& other, const_iterator first,
+              const_iterator last, size_t count);
+  // remove, remove_if and unique unlink matching nodes in a single pass and
+  // free them together at the end, so value may refer to an element of the
+  // list. They return the number of removed elements.
+  size_t remove(const T& value);
+  template <class Predicate>
+  size_t remove_if(Predicate pred);
   void reverse();
-  void unique();
+  size_t unique();
+  template <class BinaryPredicate>
+  size_t unique(BinaryPredicate pred);
   void sort();
+  template <class Compare>
+  void sort(Compare comp);
+  // Parallel sort: the list is cut into one run per hardware thread, the
+  // runs are sorted concurrently by relinking and then combined with a
+  // k-way heap merge. Stable, and allocates no nodes. Short lists are
+  // sorted on the calling thread.
+  void sort(execution::sequenced_policy) { sort(); }
+  void sort(execution::parallel_policy policy) {
+    sort(policy, std::less<T>());
+  }
+  template <class Compare>
+  void sort(execution::sequenced_policy, Compare comp) {
+    sort(comp);
+  }
+  template <class Compare>
+  void sort(execution::parallel_policy, Compare comp);
 
   // Your code goes here?..
 
  private:
+  using node_allocator =
+      typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+  using node_traits = std::allocator_traits<node_allocator>;
+
+  // Storage of an erased node while it waits in the node cache.
+  struct cached_node {
+    cached_node* next;
+  };
+
+  // Header of a block of nodes allocated together. live counts the nodes
+  // not destroyed yet; it is atomic because spliced nodes of one slab may
+  // end up in lists used by different threads.
+  struct slab {
+    slab(node* nodes, size_t count)
+        : nodes(nodes), count(count), live(count) {}
+    node* nodes;
+    size_t count;
+    std::atomic<size_t> live;
+  };
+  using slab_allocator =
+      typename std::allocator_traits<Alloc>::template rebind_alloc<slab>;
+  using slab_traits = std::allocator_traits<slab_allocator>;
+  // Most nodes one slab holds, which bounds what a surviving node retains.
+  static constexpr size_t SLAB_MAX_NODES = 256;
+
   node* head;
   node* tail;
   size_t size_;
-  Alloc allocator;
-  static inline node* end_iter = new node(nullptr);
+  node_allocator allocator;
+  cached_node* node_cache = nullptr;
+  size_t cached_count = 0;
+  size_t cache_limit = 0;
   void clear(node* n);
+
+  // Links n right before pos, or at the back when pos is null.
+  void link_before(node* pos, node* n);
+  void unlink(node* n);
+  // Same as above for an already linked chain first..last; size_ is left
+  // to the caller.
+  void link_chain_before(node* pos, node* first, node* last);
+  void unlink_chain(node* first, node* last);
+  // Destroys a null-terminated chain of unlinked nodes.
+  void destroy_chain(node* first);
+
+  // args are forwarded to the node constructor: the prev link followed by
+  // the payload's constructor arguments.
+  template <class... Args>
+  node* create_node(Args&&... args);
+  void destroy_node(node* n);
+
+  // Builds an unlinked chain of count nodes, calling make(place, prev) to
+  // construct each one in order; consecutive nodes share slabs of up to
+  // SLAB_MAX_NODES. Returns the first node and stores the last one in last.
+  template <class Make>
+  node* create_chain(size_t count, Make make, node*& last);
+  // Same for a chain of at most SLAB_MAX_NODES nodes in a single slab.
+  template <class Make>
+  node* create_slab(size_t count, Make make, node*& last);
+  // Same, one node at a time from the cache or the allocator.
+  template <class Make>
+  node* create_chain_by_node(size_t count, Make make, node*& last);
+  // Same for the elements of [first, last); single-pass iterators fall back
+  // to one allocation per node. Stores the chain length in count.
+  template <class InputIt>
+  node* create_chain(InputIt first, InputIt last, node*& chain_last,
+                     size_t& count);
+  void release_slab_node(slab* s);
+
+  // Detaches the first count nodes of the null-terminated chain starting at
+  // first and returns the rest of the chain.
+  static node* cut(node* first, size_t count);
+
+  // Appends the null-terminated chain to first..last, which may be empty.
+  static void append_chain(node*& first, node*& last, node* chain);
+
+  // Stable merge of two sorted null-terminated chains by relinking into
+  // first..last. If comp throws, first..last holds the nodes merged so far,
+  // null-terminated, and a and b what is left of their chains.
+  template <class Compare>
+  static void merge_chains(node*& a, node*& b, Compare& comp, node*& first,
+                           node*& last);
+
+  // Bottom-up merge sort of a null-terminated chain of count nodes; the
+  // sorted chain replaces first and its last node is stored in last. If comp
+  // throws, first..last is still one chain of all count nodes.
+  template <class Compare>
+  static void sort_chain(node*& first, size_t count, Compare& comp,
+                         node*& last);
+
+  // Smallest run the parallel sort hands to a thread, and the most runs it
+  // merges at once.
+  static constexpr size_t PARALLEL_SORT_MIN_RUN = 1 << 14;
+  static constexpr size_t PARALLEL_SORT_MAX_RUNS = 64;
+  template <class Compare>
+  void parallel_sort(Compare comp, size_t run_count);
 };
 
 ///////////////////////////////////////////////////////////////
 
 template <class T, class Alloc>
-list<T, Alloc>::list(size_t count, const T& value, const Alloc& alloc) {
-  allocator = alloc;
-  head = new (allocator) node(value, nullptr);
-  node* cur = head;
-  for (int i = 0; i < count - 1; i++) {
-    cur->next = new (allocator) node(value, cur);
-    cur = cur->next;
-  }
-  tail = cur;
-  size_ = count;
+list<T, Alloc>::list(size_t count, const T& value, const Alloc& alloc)
+    : list(alloc) {
+  insert(cend(), count, value);
 }
 
 template <class T, class Alloc>
-list<T, Alloc>::list(size_t count, const Alloc& alloc) {
-  allocator = alloc;
-  head = new (allocator) node(nullptr);
-  node* cur = head;
-  for (int i = 0; i < count - 1; i++) {
-    cur->next = new (allocator) node(cur);
-    cur = cur->next;
+list<T, Alloc>::list(size_t count, const Alloc& alloc) : list(alloc) {
+  node* last;
+  node* first = create_chain(
+      count,
+      [this](node* place, node* prev) {
+        node_traits::construct(allocator, place, prev);
+      },
+      last);
+  if (first) {
+    link_chain_before(nullptr, first, last);
+    size_ = count;
   }
-  tail = cur;
-  size_ = count;
 }
 
+template <class T, class Alloc>
+template <class InputIt, class>
+list<T, Alloc>::list(InputIt first, InputIt last, const Alloc& alloc)
+    : list(alloc) {
+  insert(cend(), first, last);
+}
+
+template <class T, class Alloc>
+list<T, Alloc>::list(std::initializer_list<T> init, const Alloc& alloc)
+    : list(init.begin(), init.end(), alloc) {}
+
 template <class T, class Alloc>
 list<T, Alloc>::~list() {
   clear();
+  shrink_node_cache();
 }
 
 template <class T, class Alloc>
-list<T, Alloc>::list(const list& other) {
-  node* cur = other.head;
-  while (cur != nullptr) {
-    push_back(cur->value);
-    cur = cur->next;
-    size_++;
-  }
+list<T, Alloc>::list(const list& other)
+    : head(nullptr),
+      tail(nullptr),
+      size_(0),
+      allocator(node_traits::select_on_container_copy_construction(
+          other.allocator)) {
+  insert(cend(), other.begin(), other.end());
+}
+
+template <class T, class Alloc>
+list<T, Alloc>::list(list&& other) noexcept
+    : head(other.head),
+      tail(other.tail),
+      size_(other.size_),
+      allocator(std::move(other.allocator)),
+      node_cache(other.node_cache),
+      cached_count(other.cached_count),
+      cache_limit(other.cache_limit) {
+  other.head = other.tail = nullptr;
+  other.size_ = 0;
+  other.node_cache = nullptr;
+  other.cached_count = 0;
 }
 
 template <class T, class Alloc>
 list<T, Alloc>& list<T, Alloc>::operator=(const list& other) {
-  if (this != other) {
-    list tmp(other);
-    tmp.swap(*this);
-    // destructor of tmp with prev contents of our object will be envoked
-    // automatically
+  if (this == &other) {
+    return *this;
+  }
+  if constexpr (node_traits::propagate_on_container_copy_assignment::value) {
+    if (allocator != other.allocator) {
+      // Our nodes must go back to the allocator that made them.
+      clear();
+      shrink_node_cache();
+    }
+    allocator = other.allocator;
   }
 
+  // Assign over the payloads we already have, then allocate or free only
+  // the difference in length.
+  node* dst = head;
+  node* src = other.head;
+  for (; dst && src; dst = dst->next, src = src->next) {
+    dst->value = src->value;
+  }
+  if (src) {
+    insert(cend(), const_iterator(src, &other), other.cend());
+  } else if (dst) {
+    clear(dst);
+  }
   return *this;
 }
 
 template <class T, class Alloc>
 list<T, Alloc>& list<T, Alloc>::operator=(list&& other) {
-  list(std::move(other)).swap(*this);
+  if (this == &other) {
+    return *this;
+  }
+  if constexpr (!node_traits::propagate_on_container_move_assignment::value) {
+    if (allocator != other.allocator) {
+      // Nodes must go back to the allocator that made them, so only the
+      // payloads move.
+      assign(std::make_move_iterator(other.begin()),
+             std::make_move_iterator(other.end()));
+      return *this;
+    }
+  }
+
+  clear();
+  shrink_node_cache();
+  if constexpr (node_traits::propagate_on_container_move_assignment::value) {
+    allocator = std::move(other.allocator);
+  }
+  std::swap(head, other.head);
+  std::swap(tail, other.tail);
+  std::swap(size_, other.size_);
+  std::swap(node_cache, other.node_cache);
+  std::swap(cached_count, other.cached_count);
+  std::swap(cache_limit, other.cache_limit);
   return *this;
 }
 
+template <class T, class Alloc>
+void list<T, Alloc>::assign(size_t count, const T& value) {
+  // value may refer to an element of the list: every node it is assigned to
+  // ends up equal to it, and surplus nodes are only freed at the end.
+  node* dst = head;
+  size_t assigned = 0;
+  for (; dst && assigned < count; dst = dst->next, assigned++) {
+    dst->value = value;
+  }
+  if (assigned < count) {
+    insert(cend(), count - assigned, value);
+  } else if (dst) {
+    clear(dst);
+  }
+}
+
+template <class T, class Alloc>
+template <class InputIt, class>
+void list<T, Alloc>::assign(InputIt first, InputIt last) {
+  node* dst = head;
+  for (; dst && first != last; dst = dst->next, ++first) {
+    dst->value = *first;
+  }
+  if (first != last) {
+    insert(cend(), first, last);
+  } else if (dst) {
+    clear(dst);
+  }
+}
+
+template <class T, class Alloc>
+typename list<T, Alloc>::iterator list<T, Alloc>::insert(const_iterator pos,
+                                                         size_t count,
+                                                         const T& value) {
+  node* last;
+  node* first = create_chain(
+      count,
+      [this, &value](node* place, node* prev) {
+        node_traits::construct(allocator, place, prev, value);
+      },
+      last);
+  if (!first) {
+    return iterator(pos.cur, this);
+  }
+  link_chain_before(pos.cur, first, last);
+  size_ += count;
+  return iterator(first, this);
+}
+
+template <class T, class Alloc>
+template <class InputIt, class>
+typename list<T, Alloc>::iterator list<T, Alloc>::insert(const_iterator pos,
+                                                         InputIt first,
+                                                         InputIt last) {
+  node* chain_last;
+  size_t count;
+  node* chain = create_chain(first, last, chain_last, count);
+  if (!chain) {
+    return iterator(pos.cur, this);
+  }
+  link_chain_before(pos.cur, chain, chain_last);
+  size_ += count;
+  return iterator(chain, this);
+}
+
 template <class T, class Alloc>
 void list<T, Alloc>::clear() {
   while (head) {
     auto next = head->next;
-    head->~node();
-    delete head;
+    destroy_node(head);
     head = next;
   }
   tail = nullptr;
@@ -433,42 +630,247 @@ template <class T, class Alloc>
 void list<T, Alloc>::clear(node* n) {
   int count = 0;
   tail = n->prev;
+  if (tail) {
+    tail->next = nullptr;
+  } else {
+    head = nullptr;
+  }
   while (n) {
-    T* next = n->next;
-    n->~node();
-    delete n;
+    node* next = n->next;
+    destroy_node(n);
     n = next;
     count++;
   }
   size_ -= count;
 }
 
-
 template <class T, class Alloc>
-void list<T, Alloc>::push_back(const T& value) {
-  node* new_node = new (allocator) node(value, tail);
+template <class... Args>
+typename list<T, Alloc>::node* list<T, Alloc>::create_node(Args&&... args) {
+  node* n;
+  if (node_cache) {
+    n = reinterpret_cast<node*>(node_cache);
+    node_cache = node_cache->next;
+    cached_count--;
+  } else {
+    n = node_traits::allocate(allocator, 1);
+  }
+
+  try {
+    node_traits::construct(allocator, n, std::forward<Args>(args)...);
+  } catch (...) {
+    node_traits::deallocate(allocator, n, 1);
+    throw;
+  }
+  return n;
+}
 
-  if (head == nullptr) {
-    head = tail = new_node;
+template <class T, class Alloc>
+void list<T, Alloc>::destroy_node(node* n) {
+  slab* owner = n->owner;
+  node_traits::destroy(allocator, n);
+  if (owner) {
+    release_slab_node(owner);
+  } else if (cached_count < cache_limit) {
+    node_cache = new (n) cached_node{node_cache};
+    cached_count++;
   } else {
-    tail->next = new_node;
-    tail = new_node;
+    node_traits::deallocate(allocator, n, 1);
   }
-  size_++;
 }
 
 template <class T, class Alloc>
-void list<T, Alloc>::push_back(T&& value) {
-  T val = value;
-  node* new_node = new /*(allocator)*/ node(val/*std::forward<T>(value)*/, tail);
+template <class Make>
+typename list<T, Alloc>::node* list<T, Alloc>::create_chain(size_t count,
+                                                            Make make,
+                                                            node*& last) {
+  node* first = nullptr;
+  last = nullptr;
+  try {
+    while (count > 0) {
+      size_t piece = std::min(count, SLAB_MAX_NODES);
+      node* piece_last;
+      node* piece_first = create_slab(piece, make, piece_last);
+      piece_first->prev = last;
+      if (last) {
+        last->next = piece_first;
+      } else {
+        first = piece_first;
+      }
+      last = piece_last;
+      count -= piece;
+    }
+  } catch (...) {
+    destroy_chain(first);
+    last = nullptr;
+    throw;
+  }
+  return first;
+}
 
-  if (head == nullptr) {
-    head = tail = new_node;
+template <class T, class Alloc>
+template <class Make>
+typename list<T, Alloc>::node* list<T, Alloc>::create_slab(size_t count,
+                                                           Make make,
+                                                           node*& last) {
+  last = nullptr;
+  if (count == 0) {
+    return nullptr;
+  }
+  if (count == 1) {
+    // Not worth a slab header.
+    return create_chain_by_node(count, make, last);
+  }
+
+  slab_allocator slab_alloc(allocator);
+  slab* s = slab_traits::allocate(slab_alloc, 1);
+  node* nodes;
+  try {
+    nodes = node_traits::allocate(allocator, count);
+  } catch (const std::bad_alloc&) {
+    // Allocators that serve blocks of bounded size, such as chunk pools,
+    // refuse a large slab but still hand out single nodes.
+    slab_traits::deallocate(slab_alloc, s, 1);
+    return create_chain_by_node(count, make, last);
+  }
+
+  size_t built = 0;
+  try {
+    for (; built < count; built++) {
+      node* prev = built ? nodes + built - 1 : nullptr;
+      make(nodes + built, prev);
+      nodes[built].owner = s;
+      if (prev) {
+        prev->next = nodes + built;
+      }
+    }
+  } catch (...) {
+    while (built > 0) {
+      node_traits::destroy(allocator, nodes + --built);
+    }
+    node_traits::deallocate(allocator, nodes, count);
+    slab_traits::deallocate(slab_alloc, s, 1);
+    throw;
+  }
+  slab_traits::construct(slab_alloc, s, nodes, count);
+  last = nodes + count - 1;
+  return nodes;
+}
+
+template <class T, class Alloc>
+template <class Make>
+typename list<T, Alloc>::node* list<T, Alloc>::create_chain_by_node(
+    size_t count, Make make, node*& last) {
+  node* first = nullptr;
+  last = nullptr;
+  try {
+    for (size_t i = 0; i < count; i++) {
+      node* n;
+      if (node_cache) {
+        n = reinterpret_cast<node*>(node_cache);
+        node_cache = node_cache->next;
+        cached_count--;
+      } else {
+        n = node_traits::allocate(allocator, 1);
+      }
+      try {
+        make(n, last);
+      } catch (...) {
+        node_traits::deallocate(allocator, n, 1);
+        throw;
+      }
+      if (last) {
+        last->next = n;
+      } else {
+        first = n;
+      }
+      last = n;
+    }
+  } catch (...) {
+    destroy_chain(first);
+    last = nullptr;
+    throw;
+  }
+  return first;
+}
+
+template <class T, class Alloc>
+template <class InputIt>
+typename list<T, Alloc>::node* list<T, Alloc>::create_chain(InputIt first,
+                                                            InputIt last,
+                                                            node*& chain_last,
+                                                            size_t& count) {
+  using category = typename std::iterator_traits<InputIt>::iterator_category;
+  if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value) {
+    count = std::distance(first, last);
+    return create_chain(
+        count,
+        [this, &first](node* place, node* prev) {
+          node_traits::construct(allocator, place, prev, *first);
+          ++first;
+        },
+        chain_last);
   } else {
-    tail->next = new_node;
-    tail = new_node;
+    node* chain = nullptr;
+    chain_last = nullptr;
+    count = 0;
+    try {
+      for (; first != last; ++first) {
+        node* n = create_node(chain_last, *first);
+        if (chain_last) {
+          chain_last->next = n;
+        } else {
+          chain = n;
+        }
+        chain_last = n;
+        count++;
+      }
+    } catch (...) {
+      destroy_chain(chain);
+      throw;
+    }
+    return chain;
+  }
+}
+
+template <class T, class Alloc>
+void list<T, Alloc>::release_slab_node(slab* s) {
+  if (s->live.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+  slab_allocator slab_alloc(allocator);
+  node_traits::deallocate(allocator, s->nodes, s->count);
+  slab_traits::destroy(slab_alloc, s);
+  slab_traits::deallocate(slab_alloc, s, 1);
+}
+
+template <class T, class Alloc>
+void list<T, Alloc>::set_node_cache_limit(size_t limit) {
+  cache_limit = limit;
+  while (cached_count > cache_limit) {
+    node* n = reinterpret_cast<node*>(node_cache);
+    node_cache = node_cache->next;
+    cached_count--;
+    node_traits::deallocate(allocator, n, 1);
   }
-  size_++;
+}
+
+template <class T, class Alloc>
+void list<T, Alloc>::shrink_node_cache() {
+  size_t limit = cache_limit;
+  set_node_cache_limit(0);
+  cache_limit = limit;
+}
+
+
+template <class T, class Alloc>
+void list<T, Alloc>::push_back(const T& value) {
+  link_before(nullptr, create_node(nullptr, value));
+}
+
+template <class T, class Alloc>
+void list<T, Alloc>::push_back(T&& value) {
+  link_before(nullptr, create_node(nullptr, std::move(value)));
 }
 
 template <class T, class Alloc>
@@ -478,37 +880,23 @@ void list<T, Alloc>::pop_back() {
   }
   node* tmp = tail;
   tail = tail->prev;
-  tail->next = nullptr;
-  delete tmp;
+  if (tail) {
+    tail->next = nullptr;
+  } else {
+    head = nullptr;
+  }
+  destroy_node(tmp);
   size_--;
 }
 
 template <class T, class Alloc>
 void list<T, Alloc>::push_front(const T& value) {
-  node* new_node = new (allocator) node(value, nullptr);
-
-  if (head == nullptr) {
-    head = tail = new_node;
-  } else {
-    head->prev = new_node;
-    new_node->next = head;
-    head = new_node;
-  }
-  size_++;
+  link_before(head, create_node(nullptr, value));
 }
 
 template <class T, class Alloc>
 void list<T, Alloc>::push_front(T&& value) {
-  node* new_node = new (allocator) node(std::forward<T>(value), nullptr);
-
-  if (head == nullptr) {
-    head = tail = new_node;
-  } else {
-    head->prev = new_node;
-    new_node->next = head;
-    head = new_node;
-  }
-  size_++;
+  link_before(head, create_node(nullptr, std::move(value)));
 }
 
 template <class T, class Alloc>
@@ -518,8 +906,12 @@ void list<T, Alloc>::pop_front() {
   }
   node* tmp = head;
   head = head->next;
-  head->prev = nullptr;
-  delete tmp;
+  if (head) {
+    head->prev = nullptr;
+  } else {
+    tail = nullptr;
+  }
+  destroy_node(tmp);
   size_--;
 }
 
@@ -528,182 +920,529 @@ void list<T, Alloc>::resize(size_t count) {
   // same as stl
   if (count < size_) {
     node* cur = head;
-    for (int i = 0; i < count; i++) {
+    for (size_t i = 0; i < count; i++) {
       cur = cur->next;
     }
     clear(cur);
   } else if (count > size_) {
-    for (int i = 0; i < count; i++) {
-      push_back(T());
-    }
+    size_t added = count - size_;
+    node* last;
+    node* first = create_chain(
+        added,
+        [this](node* place, node* prev) {
+          node_traits::construct(allocator, place, prev);
+        },
+        last);
+    link_chain_before(nullptr, first, last);
+    size_ += added;
   }
 }
 
 template <class T, class Alloc>
 void list<T, Alloc>::swap(list& other) {
-  list(std::move(other)).swap(*this);
+  std::swap(head, other.head);
+  std::swap(tail, other.tail);
+  std::swap(size_, other.size_);
+  if constexpr (node_traits::propagate_on_container_swap::value) {
+    std::swap(allocator, other.allocator);
+  }
+  std::swap(node_cache, other.node_cache);
+  std::swap(cached_count, other.cached_count);
+  std::swap(cache_limit, other.cache_limit);
 }
 
 template <class T, class Alloc>
 void list<T, Alloc>::merge(list& other) {
-  if (other.empty()) {
-    return;
-  }
-  node *new_list_head, this_cur, other_cur;
-  this_cur = head;
-  other_cur = other->head;
+  merge(other, std::less<T>());
+}
 
-  if (this->head->value < other->head->value) {
-    new_list_head = this->head;
-    this_cur = this_cur->next;
-  } else {
-    new_list_head = other->head;
-    other_cur = other_cur->next;
+template <class T, class Alloc>
+template <class Compare>
+void list<T, Alloc>::merge(list& other, Compare comp) {
+  if (this == &other || other.empty()) {
+    return;
   }
 
-  node* cur = new_list_head;
-
-  while (this_cur && other_cur) {
-    if (this_cur->value < other_cur->value) {
-      cur->next = this_cur;
-      cur->next->prev = cur;
-      this_cur = this_cur->next;
+  node* a = head;
+  node* b = other.head;
+  node* old_tail = tail;
+  try {
+    merge_chains(a, b, comp, head, tail);
+  } catch (...) {
+    // comp only runs while neither chain is exhausted. The merged nodes and
+    // the rest of this list stay here, still ending at the old tail; what is
+    // left of other stays there.
+    if (tail) {
+      tail->next = a;
     } else {
-      cur->next = other_cur;
-      cur->next->prev = cur;
-      other_cur = other_cur->next;
+      head = a;
+    }
+    a->prev = tail;
+    tail = old_tail;
+
+    size_t left = 0;
+    for (node* n = b; n; n = n->next) {
+      left++;
     }
-    cur = cur->next;
+    size_ += other.size_ - left;
+    other.size_ = left;
+    other.head = b;
+    b->prev = nullptr;
+    throw;
   }
+  size_ += other.size_;
 
-  node* this_tail = this_cur;
+  other.head = other.tail = nullptr;
+  other.size_ = 0;
+}
 
-  while (this_cur) {
-    cur->next = this_cur;
-    cur->next->prev = cur;
-    this_cur = this_cur->next;
-    this_tail = cur;
-    cur = cur->next;
+template <class T, class Alloc>
+void list<T, Alloc>::splice(const_iterator pos, list& other) {
+  if (this == &other || other.empty()) {
+    return;
   }
 
-  node* other_tail = other_cur;
+  link_chain_before(pos.cur, other.head, other.tail);
+  size_ += other.size_;
+
+  other.head = other.tail = nullptr;
+  other.size_ = 0;
+}
 
-  while (other_cur) {
-    cur->next = other_cur;
-    cur->next->prev = cur;
-    other_cur = other_cur->next;
-    other_tail = cur;
-    cur = cur->next;
+template <class T, class Alloc>
+void list<T, Alloc>::splice(const_iterator pos, list& other,
+                            const_iterator it) {
+  // Already in place.
+  if (this == &other && (pos.cur == it.cur || pos.cur == it.cur->next)) {
+    return;
   }
 
-  head = new_list_head;
-  tail = this_tail ? this_tail : other_tail;
-  tail->next = nullptr;
-  size_ += other->size_;
-  other->head = other->tail = nullptr;
-  other->size_ = 0;
+  other.unlink(it.cur);
+  link_before(pos.cur, it.cur);
 }
 
 template <class T, class Alloc>
-void list<T, Alloc>::remove(const T& value) {
-  if (size_ == 0) {
-    // exception ??
-  } else if (size_ == 1) {
-    if (head->value == value) {
-      delete head;
-      head = tail = nullptr;
-      size_ = 0;
-    }
+void list<T, Alloc>::splice(const_iterator pos, list& other,
+                            const_iterator first, const_iterator last) {
+  // Moving a range inside one list does not change its size.
+  size_t count = this == &other ? 0 : std::distance(first, last);
+  splice(pos, other, first, last, count);
+}
+
+template <class T, class Alloc>
+void list<T, Alloc>::splice(const_iterator pos, list& other,
+                            const_iterator first, const_iterator last,
+                            size_t count) {
+  if (first == last) {
     return;
   }
 
+  node* chain_last = last.cur ? last.cur->prev : other.tail;
+  other.unlink_chain(first.cur, chain_last);
+  other.size_ -= count;
+  link_chain_before(pos.cur, first.cur, chain_last);
+  size_ += count;
+}
+
+template <class T, class Alloc>
+size_t list<T, Alloc>::remove(const T& value) {
+  return remove_if([&value](const T& item) { return item == value; });
+}
+
+template <class T, class Alloc>
+template <class Predicate>
+size_t list<T, Alloc>::remove_if(Predicate pred) {
+  node* removed = nullptr;
+  size_t count = 0;
+
   node* cur = head;
-  while (cur != nullptr) {
-    if (cur->value == value) {
-      break;
-    }
-    cur = cur->next;
-  }
-  if (cur) {
-    if (cur == head) {
-      node* tmp = head;
-      head = head->next;
-      delete tmp;
-      return;
-    }
-    if (cur == tail) {
-      node* tmp = tail;
-      tail = tail->prev;
-      delete tmp;
-      return;
-    }
-    cur->prev->next = cur->next;
-    cur->next->prev = cur->prev;
-    delete cur;
-    return;
+  while (cur) {
+    node* next = cur->next;
+    if (pred(cur->value)) {
+      unlink(cur);
+      cur->next = removed;
+      removed = cur;
+      count++;
+    }
+    cur = next;
   }
+
+  destroy_chain(removed);
+  return count;
 }
 
 template <class T, class Alloc>
 void list<T, Alloc>::reverse() {
-  node* tmp = nullptr;
   node* cur = head;
-
   while (cur != nullptr) {
-    tmp = cur->prev;
-    cur->prev = cur->next;
-    cur->next = tmp;
+    std::swap(cur->prev, cur->next);
     cur = cur->prev;
   }
+  std::swap(head, tail);
+}
 
-  if (tmp != nullptr) {
-    head = tmp->prev;
+template <class T, class Alloc>
+size_t list<T, Alloc>::unique() {
+  return unique(std::equal_to<T>());
+}
+
+template <class T, class Alloc>
+template <class BinaryPredicate>
+size_t list<T, Alloc>::unique(BinaryPredicate pred) {
+  if (!head) {
+    return 0;
   }
+
+  node* removed = nullptr;
+  size_t count = 0;
+
+  node* kept = head;
+  node* cur = head->next;
+  while (cur) {
+    node* next = cur->next;
+    if (pred(kept->value, cur->value)) {
+      unlink(cur);
+      cur->next = removed;
+      removed = cur;
+      count++;
+    } else {
+      kept = cur;
+    }
+    cur = next;
+  }
+
+  destroy_chain(removed);
+  return count;
 }
 
 template <class T, class Alloc>
-void list<T, Alloc>::unique() {
-  if (size_ == 0 || size_ == 1) {
+void list<T, Alloc>::sort() {
+  sort(std::less<T>());
+}
+
+template <class T, class Alloc>
+template <class Compare>
+void list<T, Alloc>::sort(Compare comp) {
+  if (size_ < 2) {
     return;
   }
+  sort_chain(head, size_, comp, tail);
+}
 
-  node* cur = head;
-  node* next;
+template <class T, class Alloc>
+template <class Compare>
+void list<T, Alloc>::sort(execution::parallel_policy, Compare comp) {
+  size_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+  size_t run_count = std::min({size_t(threads), PARALLEL_SORT_MAX_RUNS,
+                               size_ / PARALLEL_SORT_MIN_RUN});
+  if (run_count < 2) {
+    sort(comp);
+  } else {
+    parallel_sort(comp, run_count);
+  }
+}
 
-  while (cur->next != nullptr) {
-    if (cur->value == cur->next->value) {
-      remove(cur->value);
-    } else {
-      cur = cur->next;
+template <class T, class Alloc>
+template <class Compare>
+void list<T, Alloc>::parallel_sort(Compare comp, size_t run_count) {
+  // first is the next node of the run still to be merged, or null once the
+  // run is used up.
+  struct run {
+    node* first;
+    node* last;
+    size_t count;
+  };
+  std::array<run, PARALLEL_SORT_MAX_RUNS> runs{};
+
+  // Every thread sorts its run with its own copy of comp; the calling
+  // thread takes the first run. comp is copied before the list is cut.
+  std::array<std::exception_ptr, PARALLEL_SORT_MAX_RUNS> errors;
+  auto sort_run = [&runs, &errors, comp](size_t i) mutable {
+    try {
+      sort_chain(runs[i].first, runs[i].count, comp, runs[i].last);
+    } catch (...) {
+      errors[i] = std::current_exception();
     }
+  };
+
+  node* rest = head;
+  for (size_t i = 0; i < run_count; i++) {
+    runs[i].first = rest;
+    runs[i].count = size_ / run_count + (i < size_ % run_count ? 1 : 0);
+    rest = cut(rest, runs[i].count);
+    // cut leaves prev links alone.
+    runs[i].last = rest ? rest->prev : tail;
+  }
+
+  // Whatever throws, the merged prefix and what is left of every run stay
+  // valid chains, so they are linked back into one list.
+  node* new_head = nullptr;
+  node* new_tail = nullptr;
+  auto relink_runs = [this, &runs, run_count, &new_head, &new_tail] {
+    head = new_head;
+    tail = new_tail;
+    if (tail) {
+      tail->next = nullptr;
+    }
+    for (size_t i = 0; i < run_count; i++) {
+      if (runs[i].first) {
+        link_chain_before(nullptr, runs[i].first, runs[i].last);
+      }
+    }
+  };
+
+  std::array<std::thread, PARALLEL_SORT_MAX_RUNS> workers;
+  size_t started = 1;
+  try {
+    for (; started < run_count; started++) {
+      workers[started] = std::thread(sort_run, started);
+    }
+  } catch (...) {
+    // The runs already handed out are still being sorted.
+    for (size_t i = 1; i < started; i++) {
+      workers[i].join();
+    }
+    relink_runs();
+    throw;
   }
+  sort_run(0);
+  for (size_t i = 1; i < run_count; i++) {
+    workers[i].join();
+  }
+  for (size_t i = 0; i < run_count; i++) {
+    if (errors[i]) {
+      relink_runs();
+      std::rethrow_exception(errors[i]);
+    }
+  }
+
+  // Min-heap of run heads. Equal elements are taken from the earlier run,
+  // which keeps the sort stable.
+  struct cursor {
+    node* n;
+    size_t run;
+  };
+  std::array<cursor, PARALLEL_SORT_MAX_RUNS> heap;
+  auto after = [&comp](const cursor& a, const cursor& b) {
+    if (comp(b.n->value, a.n->value)) {
+      return true;
+    }
+    return !comp(a.n->value, b.n->value) && a.run > b.run;
+  };
+  size_t heap_size = 0;
+  for (size_t i = 0; i < run_count; i++) {
+    heap[heap_size++] = cursor{runs[i].first, i};
+  }
+
+  // A throwing comp may leave the heap scrambled, so the runs themselves
+  // track what has been merged.
+  try {
+    std::make_heap(heap.begin(), heap.begin() + heap_size, after);
+    while (heap_size > 1) {
+      std::pop_heap(heap.begin(), heap.begin() + heap_size, after);
+      cursor& top = heap[heap_size - 1];
+      node* n = top.n;
+      if (new_tail) {
+        new_tail->next = n;
+      } else {
+        new_head = n;
+      }
+      n->prev = new_tail;
+      new_tail = n;
+      runs[top.run].first = n->next;
+
+      if (n->next) {
+        top.n = n->next;
+        std::push_heap(heap.begin(), heap.begin() + heap_size, after);
+      } else {
+        heap_size--;
+      }
+    }
+  } catch (...) {
+    relink_runs();
+    throw;
+  }
+
+  // The last run left is already linked in order.
+  const cursor& remaining = heap[0];
+  new_tail->next = remaining.n;
+  remaining.n->prev = new_tail;
+  head = new_head;
+  tail = runs[remaining.run].last;
 }
 
+// Bottom-up merge sort: runs of width 1, 2, 4, ... are merged pairwise by
+// relinking nodes, so no payload is copied and no extra memory is used.
 template <class T, class Alloc>
-void list<T, Alloc>::sort() {
-  int i;
-  bool swapped;
-  node* ptr;
-  node* lptr = nullptr;
+template <class Compare>
+void list<T, Alloc>::sort_chain(node*& first, size_t count, Compare& comp,
+                                node*& last) {
+  last = first;
+  for (size_t width = 1; width < count; width *= 2) {
+    node* rest = first;
+    node* new_head = nullptr;
+    node* new_tail = nullptr;
+
+    while (rest) {
+      node* left = rest;
+      node* right = cut(left, width);
+      rest = cut(right, width);
+
+      node* merged;
+      node* merged_last;
+      try {
+        merge_chains(left, right, comp, merged, merged_last);
+      } catch (...) {
+        // Every piece keeps its internal links, so gluing them back together
+        // in any order leaves one valid chain.
+        for (node* chain : {merged, left, right, rest}) {
+          append_chain(new_head, new_tail, chain);
+        }
+        first = new_head;
+        last = new_tail;
+        throw;
+      }
+      if (new_tail) {
+        new_tail->next = merged;
+        merged->prev = new_tail;
+      } else {
+        new_head = merged;
+      }
+      new_tail = merged_last;
+    }
 
-  if (size_ == 0) {
+    first = new_head;
+    last = new_tail;
+  }
+}
+
+template <class T, class Alloc>
+void list<T, Alloc>::link_before(node* pos, node* n) {
+  link_chain_before(pos, n, n);
+  size_++;
+}
+
+template <class T, class Alloc>
+void list<T, Alloc>::unlink(node* n) {
+  unlink_chain(n, n);
+  size_--;
+}
+
+template <class T, class Alloc>
+void list<T, Alloc>::link_chain_before(node* pos, node* first, node* last) {
+  node* prev = pos ? pos->prev : tail;
+  first->prev = prev;
+  last->next = pos;
+  if (prev) {
+    prev->next = first;
+  } else {
+    head = first;
+  }
+  if (pos) {
+    pos->prev = last;
+  } else {
+    tail = last;
+  }
+}
+
+template <class T, class Alloc>
+void list<T, Alloc>::unlink_chain(node* first, node* last) {
+  if (first->prev) {
+    first->prev->next = last->next;
+  } else {
+    head = last->next;
+  }
+  if (last->next) {
+    last->next->prev = first->prev;
+  } else {
+    tail = first->prev;
+  }
+}
+
+template <class T, class Alloc>
+void list<T, Alloc>::destroy_chain(node* first) {
+  while (first) {
+    node* next = first->next;
+    destroy_node(first);
+    first = next;
+  }
+}
+
+template <class T, class Alloc>
+typename list<T, Alloc>::node* list<T, Alloc>::cut(node* first,
+                                                   size_t count) {
+  for (size_t i = 1; first && i < count; i++) {
+    first = first->next;
+  }
+  if (!first) {
+    return nullptr;
+  }
+  node* rest = first->next;
+  first->next = nullptr;
+  return rest;
+}
+
+template <class T, class Alloc>
+void list<T, Alloc>::append_chain(node*& first, node*& last, node* chain) {
+  if (!chain) {
     return;
   }
+  if (last) {
+    last->next = chain;
+  } else {
+    first = chain;
+  }
+  chain->prev = last;
+  for (last = chain; last->next; last = last->next) {
+  }
+}
 
-  node* start = head;
-  do {
-    swapped = 0;
-    ptr = start;
+template <class T, class Alloc>
+template <class Compare>
+void list<T, Alloc>::merge_chains(node*& a, node*& b, Compare& comp,
+                                  node*& first, node*& last) {
+  first = last = nullptr;
+  auto append = [&first, &last](node* n) {
+    if (last) {
+      last->next = n;
+    } else {
+      first = n;
+    }
+    n->prev = last;
+    last = n;
+  };
 
-    while (ptr->next != lptr) {
-      if (ptr->data > ptr->next->data) {
-        swap(ptr->data, ptr->next->data);
-        swapped = 1;
+  try {
+    while (a && b) {
+      // Ties are taken from a, which keeps the merge stable.
+      if (comp(b->value, a->value)) {
+        node* next = b->next;
+        append(b);
+        b = next;
+      } else {
+        node* next = a->next;
+        append(a);
+        a = next;
       }
-      ptr = ptr->next;
     }
-    lptr = ptr;
-  } while (swapped);
+  } catch (...) {
+    // The last merged node still points into a or b.
+    if (last) {
+      last->next = nullptr;
+    }
+    throw;
+  }
+
+  // The leftover chain is already linked in order.
+  append_chain(first, last, a ? a : b);
+  a = b = nullptr;
 }
 
+namespace pmr {
+// Counterpart of std::pmr::list: lists of one element type have one type
+// whatever memory resource they draw from.
+template <class T>
+using list = task::list<T, std::pmr::polymorphic_allocator<T>>;
+}  // namespace pmr
+
 }  // namespace task
\ No newline at end of file
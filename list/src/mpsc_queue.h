@@ -0,0 +1,109 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace task {
+
+// Lock-free multi-producer single-consumer queue. Nodes mirror
+// task::list<T>::node (a payload plus a link), except that the link is
+// atomic, and are allocated through the rebound Alloc, which therefore must
+// be usable from several threads at once.
+//
+// Producers publish a node with one atomic exchange and never touch it again
+// after linking it, and only the consumer frees nodes, so no hazard pointers
+// or epochs are needed. Any number of threads may push concurrently; pops
+// must not run concurrently with each other.
+template <class T, class Alloc = std::allocator<T>>
+class mpsc_queue {
+  struct node {
+    std::atomic<node*> next;
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    node() : next(nullptr) {}
+    T* value() { return std::launder(reinterpret_cast<T*>(storage)); }
+  };
+
+ public:
+  mpsc_queue() : mpsc_queue(Alloc()) {}
+  explicit mpsc_queue(const Alloc& alloc) : allocator(alloc) {
+    // The queue always holds one node whose payload was already consumed.
+    node* stub = create_node();
+    head.store(stub, std::memory_order_relaxed);
+    tail = stub;
+  }
+
+  mpsc_queue(const mpsc_queue&) = delete;
+  mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+  ~mpsc_queue() {
+    while (node* next = tail->next.load(std::memory_order_relaxed)) {
+      node_traits::destroy(allocator, next->value());
+      destroy_node(tail);
+      tail = next;
+    }
+    destroy_node(tail);
+  }
+
+  void push(const T& value) { emplace(value); }
+  void push(T&& value) { emplace(std::move(value)); }
+
+  template <class... Args>
+  void emplace(Args&&... args) {
+    node* n = create_node();
+    try {
+      node_traits::construct(allocator, n->value(),
+                             std::forward<Args>(args)...);
+    } catch (...) {
+      destroy_node(n);
+      throw;
+    }
+
+    node* prev = head.exchange(n, std::memory_order_acq_rel);
+    prev->next.store(n, std::memory_order_release);
+  }
+
+  // Consumer only. Returns false if the queue is empty or the next producer
+  // has not finished linking its node yet.
+  bool try_pop(T& value) {
+    node* next = tail->next.load(std::memory_order_acquire);
+    if (!next) {
+      return false;
+    }
+
+    value = std::move(*next->value());
+    node_traits::destroy(allocator, next->value());
+    destroy_node(tail);
+    tail = next;
+    return true;
+  }
+
+  // Consumer only.
+  bool empty() const {
+    return tail->next.load(std::memory_order_acquire) == nullptr;
+  }
+
+ private:
+  using node_allocator =
+      typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+  using node_traits = std::allocator_traits<node_allocator>;
+
+  // Producers and the consumer work on different ends; keep them on
+  // separate cache lines.
+  alignas(64) std::atomic<node*> head;
+  alignas(64) node* tail;
+  node_allocator allocator;
+
+  node* create_node() {
+    node* n = node_traits::allocate(allocator, 1);
+    return new (n) node();
+  }
+
+  void destroy_node(node* n) {
+    n->~node();
+    node_traits::deallocate(allocator, n, 1);
+  }
+};
+
+}  // namespace task
@@ -0,0 +1,721 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace task {
+
+// Sibling of task::list that keeps up to NodeCapacity elements in every node,
+// so iteration touches one cache line per several elements instead of one per
+// element, while insertion in the middle still only shifts one node.
+//
+// Unlike task::list, elements are moved between slots when a node is split,
+// merged or shifted: insert and erase invalidate iterators and references to
+// the elements of the affected node and its neighbours.
+template <class T, class Alloc = std::allocator<T>,
+          size_t NodeCapacity = (sizeof(T) < 64 ? 256 / sizeof(T) : 4)>
+class unrolled_list {
+  static_assert(NodeCapacity >= 2, "Node must hold at least two elements");
+  static_assert(std::is_move_constructible<T>::value,
+                "Elements are moved between slots and must be movable");
+
+  struct node {
+    node* prev = nullptr;
+    node* next = nullptr;
+    size_t count = 0;
+    alignas(T) unsigned char storage[NodeCapacity * sizeof(T)];
+
+    T* slot(size_t i) {
+      return std::launder(reinterpret_cast<T*>(storage)) + i;
+    }
+  };
+
+  template <bool IsConst>
+  class basic_iterator {
+    friend class unrolled_list;
+    friend class basic_iterator<!IsConst>;
+
+   public:
+    using difference_type = ptrdiff_t;
+    using value_type = T;
+    using pointer = std::conditional_t<IsConst, const T*, T*>;
+    using reference = std::conditional_t<IsConst, const T&, T&>;
+    using iterator_category = std::bidirectional_iterator_tag;
+
+    basic_iterator() : cur(nullptr), index(0), owner(nullptr) {}
+
+    template <bool C = IsConst, typename = std::enable_if_t<C>>
+    basic_iterator(const basic_iterator<false>& other)
+        : cur(other.cur), index(other.index), owner(other.owner) {}
+
+    reference operator*() const { return *cur->slot(index); }
+    pointer operator->() const { return cur->slot(index); }
+
+    basic_iterator& operator++() {
+      if (++index == cur->count) {
+        cur = cur->next;
+        index = 0;
+      }
+      return *this;
+    }
+    basic_iterator operator++(int) {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+    basic_iterator& operator--() {
+      if (!cur) {
+        cur = owner->tail;
+        index = cur->count - 1;
+      } else if (index == 0) {
+        cur = cur->prev;
+        index = cur->count - 1;
+      } else {
+        index--;
+      }
+      return *this;
+    }
+    basic_iterator operator--(int) {
+      auto tmp = *this;
+      --*this;
+      return tmp;
+    }
+
+    template <bool C>
+    bool operator==(const basic_iterator<C>& other) const {
+      return cur == other.cur && index == other.index;
+    }
+    template <bool C>
+    bool operator!=(const basic_iterator<C>& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    basic_iterator(node* cur, size_t index, const unrolled_list* owner)
+        : cur(cur), index(index), owner(owner) {}
+
+    node* cur;
+    size_t index;
+    const unrolled_list* owner;
+  };
+
+ public:
+  using value_type = T;
+  using allocator_type = Alloc;
+  using size_type = size_t;
+  using reference = T&;
+  using const_reference = const T&;
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  unrolled_list() : unrolled_list(Alloc()) {}
+  explicit unrolled_list(const Alloc& alloc)
+      : head(nullptr), tail(nullptr), size_(0), allocator(alloc) {}
+  unrolled_list(size_t count, const T& value, const Alloc& alloc = Alloc())
+      : unrolled_list(alloc) {
+    insert(cend(), count, value);
+  }
+  explicit unrolled_list(size_t count, const Alloc& alloc = Alloc())
+      : unrolled_list(alloc) {
+    for (size_t i = 0; i < count; i++) {
+      emplace_back();
+    }
+  }
+
+  ~unrolled_list() { clear(); }
+
+  unrolled_list(const unrolled_list& other)
+      : unrolled_list(node_traits::select_on_container_copy_construction(
+            other.allocator)) {
+    for (const auto& value : other) {
+      push_back(value);
+    }
+  }
+  unrolled_list(unrolled_list&& other) noexcept
+      : unrolled_list(Alloc(other.allocator)) {
+    swap(other);
+  }
+  unrolled_list& operator=(const unrolled_list& other) {
+    if (this != &other) {
+      unrolled_list(other).swap(*this);
+    }
+    return *this;
+  }
+  unrolled_list& operator=(unrolled_list&& other) noexcept {
+    unrolled_list(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  Alloc get_allocator() const { return Alloc(allocator); }
+
+  T& front() { return *head->slot(0); }
+  const T& front() const { return *head->slot(0); }
+
+  T& back() { return *tail->slot(tail->count - 1); }
+  const T& back() const { return *tail->slot(tail->count - 1); }
+
+  iterator begin() { return iterator(head, 0, this); }
+  iterator end() { return iterator(nullptr, 0, this); }
+  const_iterator begin() const { return cbegin(); }
+  const_iterator end() const { return cend(); }
+
+  const_iterator cbegin() const { return const_iterator(head, 0, this); }
+  const_iterator cend() const { return const_iterator(nullptr, 0, this); }
+
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+
+  const_reverse_iterator crbegin() const {
+    return const_reverse_iterator(cend());
+  }
+  const_reverse_iterator crend() const {
+    return const_reverse_iterator(cbegin());
+  }
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+  size_t max_size() const {
+    return node_traits::max_size(allocator) * NodeCapacity;
+  }
+  static constexpr size_t node_capacity() { return NodeCapacity; }
+
+  void clear();
+
+  iterator insert(const_iterator pos, const T& value) {
+    return emplace(pos, value);
+  }
+  iterator insert(const_iterator pos, T&& value) {
+    return emplace(pos, std::move(value));
+  }
+  iterator insert(const_iterator pos, size_t count, const T& value);
+
+  template <class... Args>
+  iterator emplace(const_iterator pos, Args&&... args);
+
+  iterator erase(const_iterator pos) { return erase(pos, std::next(pos)); }
+  iterator erase(const_iterator first, const_iterator last);
+
+  void push_back(const T& value) { emplace_back(value); }
+  void push_back(T&& value) { emplace_back(std::move(value)); }
+  void pop_back() { erase(std::prev(cend())); }
+
+  void push_front(const T& value) { emplace_front(value); }
+  void push_front(T&& value) { emplace_front(std::move(value)); }
+  void pop_front() { erase(cbegin()); }
+
+  template <class... Args>
+  void emplace_back(Args&&... args) {
+    emplace(cend(), std::forward<Args>(args)...);
+  }
+  template <class... Args>
+  void emplace_front(Args&&... args) {
+    emplace(cbegin(), std::forward<Args>(args)...);
+  }
+
+  void resize(size_t count);
+  void swap(unrolled_list& other) noexcept;
+
+  void merge(unrolled_list& other) { merge(other, std::less<T>()); }
+  template <class Compare>
+  void merge(unrolled_list& other, Compare comp);
+
+  // Moves the elements of other before pos. The whole-list overload relinks
+  // nodes and runs in O(NodeCapacity); the others move elements one by one.
+  void splice(const_iterator pos, unrolled_list& other);
+  void splice(const_iterator pos, unrolled_list& other, const_iterator it) {
+    splice(pos, other, it, std::next(it));
+  }
+  void splice(const_iterator pos, unrolled_list& other, const_iterator first,
+              const_iterator last);
+
+  size_t remove(const T& value);
+  template <class Predicate>
+  size_t remove_if(Predicate pred);
+  void reverse();
+  size_t unique() { return unique(std::equal_to<T>()); }
+  template <class BinaryPredicate>
+  size_t unique(BinaryPredicate pred);
+  void sort() { sort(std::less<T>()); }
+  template <class Compare>
+  void sort(Compare comp);
+
+ private:
+  using node_allocator =
+      typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+  using node_traits = std::allocator_traits<node_allocator>;
+
+  node* head;
+  node* tail;
+  size_t size_;
+  node_allocator allocator;
+
+  node* create_node();
+  void destroy_node(node* n);
+  // Links n right after pos, or at the front when pos is null.
+  void link_after(node* pos, node* n);
+  void unlink(node* n);
+
+  template <class... Args>
+  void construct(T* p, Args&&... args) {
+    node_traits::construct(allocator, p, std::forward<Args>(args)...);
+  }
+  void destroy(T* p) { node_traits::destroy(allocator, p); }
+  void relocate(T* from, T* to) {
+    construct(to, std::move(*from));
+    destroy(from);
+  }
+
+  // Moves the elements [at, count) of n into a new node linked after n.
+  node* split(node* n, size_t at);
+  // Moves all elements of b to the end of a and frees b.
+  void absorb(node* a, node* b);
+  // Merges n with sparse neighbours after an erase and returns the iterator
+  // to the element that was at (n, index).
+  iterator rebalance(node* n, size_t index);
+  // Returns the node after which elements have to be appended to end up
+  // right before pos, splitting the node of pos if needed.
+  node* open_gap(const_iterator pos);
+  iterator nth(size_t index);
+};
+
+///////////////////////////////////////////////////////////////
+
+template <class T, class Alloc, size_t N>
+void unrolled_list<T, Alloc, N>::clear() {
+  while (head) {
+    node* next = head->next;
+    for (size_t i = 0; i < head->count; i++) {
+      destroy(head->slot(i));
+    }
+    destroy_node(head);
+    head = next;
+  }
+  tail = nullptr;
+  size_ = 0;
+}
+
+template <class T, class Alloc, size_t N>
+typename unrolled_list<T, Alloc, N>::iterator
+unrolled_list<T, Alloc, N>::insert(const_iterator pos, size_t count,
+                                   const T& value) {
+  if (count == 0) {
+    return iterator(pos.cur, pos.index, this);
+  }
+
+  // value may live in the node that open_gap is about to split.
+  const T copy(value);
+  node* n = open_gap(pos);
+  node* first = nullptr;
+  size_t first_index = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    if (!n || n->count == N) {
+      node* new_node = create_node();
+      link_after(n, new_node);
+      n = new_node;
+    }
+    construct(n->slot(n->count), copy);
+    if (!first) {
+      first = n;
+      first_index = n->count;
+    }
+    n->count++;
+    size_++;
+  }
+
+  return iterator(first, first_index, this);
+}
+
+template <class T, class Alloc, size_t N>
+template <class... Args>
+typename unrolled_list<T, Alloc, N>::iterator
+unrolled_list<T, Alloc, N>::emplace(const_iterator pos, Args&&... args) {
+  node* n = pos.cur;
+  size_t index = pos.index;
+
+  // Appending to a node with free space needs no shifting, so the element
+  // is constructed in place from args.
+  if (!n && tail && tail->count < N) {
+    n = tail;
+    index = n->count;
+  } else if (n && index == 0 && n->prev && n->prev->count < N) {
+    n = n->prev;
+    index = n->count;
+  }
+
+  // A new node is linked only once its element exists, so a throwing
+  // constructor leaves no empty node behind.
+  if (!n) {
+    n = create_node();
+    try {
+      construct(n->slot(0), std::forward<Args>(args)...);
+    } catch (...) {
+      destroy_node(n);
+      throw;
+    }
+    link_after(tail, n);
+    n->count++;
+    size_++;
+    return iterator(n, 0, this);
+  }
+
+  if (index == n->count) {
+    construct(n->slot(index), std::forward<Args>(args)...);
+  } else {
+    // args may refer to elements that are about to be shifted.
+    T value(std::forward<Args>(args)...);
+    if (n->count == N) {
+      node* upper = split(n, N / 2);
+      if (index > N / 2) {
+        n = upper;
+        index -= N / 2;
+      }
+    }
+    for (size_t i = n->count; i > index; i--) {
+      relocate(n->slot(i - 1), n->slot(i));
+    }
+    construct(n->slot(index), std::move(value));
+  }
+
+  n->count++;
+  size_++;
+  return iterator(n, index, this);
+}
+
+template <class T, class Alloc, size_t N>
+typename unrolled_list<T, Alloc, N>::iterator
+unrolled_list<T, Alloc, N>::erase(const_iterator first, const_iterator last) {
+  node* n = first.cur;
+  size_t index = first.index;
+
+  while (n != last.cur || index != last.index) {
+    bool last_node = n == last.cur;
+    size_t stop = last_node ? last.index : n->count;
+    size_t removed = stop - index;
+
+    for (size_t i = index; i < stop; i++) {
+      destroy(n->slot(i));
+    }
+    for (size_t i = stop; i < n->count; i++) {
+      relocate(n->slot(i), n->slot(i - removed));
+    }
+    n->count -= removed;
+    size_ -= removed;
+
+    // The element at last has just been shifted to index.
+    if (last_node) {
+      break;
+    }
+    if (n->count == 0) {
+      node* next = n->next;
+      unlink(n);
+      destroy_node(n);
+      n = next;
+      index = 0;
+    } else if (index == n->count) {
+      n = n->next;
+      index = 0;
+    }
+  }
+
+  return rebalance(n, index);
+}
+
+template <class T, class Alloc, size_t N>
+void unrolled_list<T, Alloc, N>::resize(size_t count) {
+  if (count < size_) {
+    erase(nth(count), end());
+  }
+  while (size_ < count) {
+    emplace_back();
+  }
+}
+
+template <class T, class Alloc, size_t N>
+void unrolled_list<T, Alloc, N>::swap(unrolled_list& other) noexcept {
+  std::swap(head, other.head);
+  std::swap(tail, other.tail);
+  std::swap(size_, other.size_);
+  std::swap(allocator, other.allocator);
+}
+
+template <class T, class Alloc, size_t N>
+template <class Compare>
+void unrolled_list<T, Alloc, N>::merge(unrolled_list& other, Compare comp) {
+  if (this == &other) {
+    return;
+  }
+
+  unrolled_list result(get_allocator());
+  auto a = begin();
+  auto b = other.begin();
+  while (a != end() && b != other.end()) {
+    // Ties are taken from this list, which keeps the merge stable.
+    if (comp(*b, *a)) {
+      result.emplace_back(std::move(*b++));
+    } else {
+      result.emplace_back(std::move(*a++));
+    }
+  }
+  for (; a != end(); ++a) {
+    result.emplace_back(std::move(*a));
+  }
+  for (; b != other.end(); ++b) {
+    result.emplace_back(std::move(*b));
+  }
+
+  other.clear();
+  swap(result);
+}
+
+template <class T, class Alloc, size_t N>
+void unrolled_list<T, Alloc, N>::splice(const_iterator pos,
+                                        unrolled_list& other) {
+  if (this == &other || other.empty()) {
+    return;
+  }
+
+  node* before = open_gap(pos);
+  node* after = before ? before->next : head;
+
+  other.head->prev = before;
+  if (before) {
+    before->next = other.head;
+  } else {
+    head = other.head;
+  }
+  other.tail->next = after;
+  if (after) {
+    after->prev = other.tail;
+  } else {
+    tail = other.tail;
+  }
+
+  size_ += other.size_;
+  other.head = other.tail = nullptr;
+  other.size_ = 0;
+}
+
+template <class T, class Alloc, size_t N>
+void unrolled_list<T, Alloc, N>::splice(const_iterator pos,
+                                        unrolled_list& other,
+                                        const_iterator first,
+                                        const_iterator last) {
+  if (first == last) {
+    return;
+  }
+
+  if (this != &other) {
+    for (auto it = first; it != last; ++it) {
+      pos = std::next(emplace(pos, std::move(*iterator(it.cur, it.index,
+                                                          &other))));
+    }
+    other.erase(first, last);
+    return;
+  }
+
+  // Within one list positions shift while elements move, so the range is
+  // moved out through a buffer and reinserted by ordinal position.
+  size_t to = std::distance(cbegin(), pos);
+  size_t from = std::distance(cbegin(), first);
+  size_t count = std::distance(first, last);
+  if (to >= from && to <= from + count) {
+    return;
+  }
+
+  std::vector<T> buffer;
+  buffer.reserve(count);
+  for (auto it = first; it != last; ++it) {
+    buffer.push_back(std::move(*iterator(it.cur, it.index, this)));
+  }
+  erase(first, last);
+
+  const_iterator it = nth(to > from ? to - count : to);
+  for (auto& value : buffer) {
+    it = std::next(emplace(it, std::move(value)));
+  }
+}
+
+template <class T, class Alloc, size_t N>
+size_t unrolled_list<T, Alloc, N>::remove(const T& value) {
+  // value may be an element of this list, which compaction overwrites.
+  const T copy(value);
+  return remove_if([&copy](const T& item) { return item == copy; });
+}
+
+template <class T, class Alloc, size_t N>
+template <class Predicate>
+size_t unrolled_list<T, Alloc, N>::remove_if(Predicate pred) {
+  size_t old_size = size_;
+  erase(std::remove_if(begin(), end(), pred), end());
+  return old_size - size_;
+}
+
+template <class T, class Alloc, size_t N>
+void unrolled_list<T, Alloc, N>::reverse() {
+  for (node* n = head; n; n = n->prev) {
+    std::swap(n->prev, n->next);
+    std::reverse(n->slot(0), n->slot(n->count));
+  }
+  std::swap(head, tail);
+}
+
+template <class T, class Alloc, size_t N>
+template <class BinaryPredicate>
+size_t unrolled_list<T, Alloc, N>::unique(BinaryPredicate pred) {
+  size_t old_size = size_;
+  erase(std::unique(begin(), end(), pred), end());
+  return old_size - size_;
+}
+
+// Pointers to the elements are sorted first, so a throwing comparator
+// leaves the list as it was. The elements are then moved through a buffer
+// back into the same slots in sorted order, and the node structure is left
+// untouched.
+template <class T, class Alloc, size_t N>
+template <class Compare>
+void unrolled_list<T, Alloc, N>::sort(Compare comp) {
+  if (size_ < 2) {
+    return;
+  }
+
+  std::vector<T*> order;
+  order.reserve(size_);
+  for (auto& value : *this) {
+    order.push_back(&value);
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [&comp](T* lhs, T* rhs) { return comp(*lhs, *rhs); });
+
+  std::vector<T> buffer;
+  buffer.reserve(size_);
+  for (T* value : order) {
+    buffer.push_back(std::move(*value));
+  }
+  std::move(buffer.begin(), buffer.end(), begin());
+}
+
+template <class T, class Alloc, size_t N>
+typename unrolled_list<T, Alloc, N>::node*
+unrolled_list<T, Alloc, N>::create_node() {
+  node* n = node_traits::allocate(allocator, 1);
+  return new (n) node;
+}
+
+template <class T, class Alloc, size_t N>
+void unrolled_list<T, Alloc, N>::destroy_node(node* n) {
+  n->~node();
+  node_traits::deallocate(allocator, n, 1);
+}
+
+template <class T, class Alloc, size_t N>
+void unrolled_list<T, Alloc, N>::link_after(node* pos, node* n) {
+  node* next = pos ? pos->next : head;
+  n->prev = pos;
+  n->next = next;
+  if (pos) {
+    pos->next = n;
+  } else {
+    head = n;
+  }
+  if (next) {
+    next->prev = n;
+  } else {
+    tail = n;
+  }
+}
+
+template <class T, class Alloc, size_t N>
+void unrolled_list<T, Alloc, N>::unlink(node* n) {
+  if (n->prev) {
+    n->prev->next = n->next;
+  } else {
+    head = n->next;
+  }
+  if (n->next) {
+    n->next->prev = n->prev;
+  } else {
+    tail = n->prev;
+  }
+}
+
+template <class T, class Alloc, size_t N>
+typename unrolled_list<T, Alloc, N>::node* unrolled_list<T, Alloc, N>::split(
+    node* n, size_t at) {
+  node* upper = create_node();
+  for (size_t i = at; i < n->count; i++) {
+    relocate(n->slot(i), upper->slot(i - at));
+  }
+  upper->count = n->count - at;
+  n->count = at;
+  link_after(n, upper);
+  return upper;
+}
+
+template <class T, class Alloc, size_t N>
+void unrolled_list<T, Alloc, N>::absorb(node* a, node* b) {
+  for (size_t i = 0; i < b->count; i++) {
+    relocate(b->slot(i), a->slot(a->count + i));
+  }
+  a->count += b->count;
+  unlink(b);
+  destroy_node(b);
+}
+
+// Two neighbouring nodes are merged once they fit into half a node, which
+// keeps the average fill above a quarter under any erase pattern.
+template <class T, class Alloc, size_t N>
+typename unrolled_list<T, Alloc, N>::iterator
+unrolled_list<T, Alloc, N>::rebalance(node* n, size_t index) {
+  if (!n) {
+    return end();
+  }
+
+  if (n->next && n->count + n->next->count <= N / 2) {
+    absorb(n, n->next);
+  }
+  if (n->prev && n->prev->count + n->count <= N / 2) {
+    node* prev = n->prev;
+    index += prev->count;
+    absorb(prev, n);
+    n = prev;
+  }
+
+  if (index == n->count) {
+    return iterator(n->next, 0, this);
+  }
+  return iterator(n, index, this);
+}
+
+template <class T, class Alloc, size_t N>
+typename unrolled_list<T, Alloc, N>::node*
+unrolled_list<T, Alloc, N>::open_gap(const_iterator pos) {
+  if (!pos.cur) {
+    return tail;
+  }
+  if (pos.index == 0) {
+    return pos.cur->prev;
+  }
+  split(pos.cur, pos.index);
+  return pos.cur;
+}
+
+template <class T, class Alloc, size_t N>
+typename unrolled_list<T, Alloc, N>::iterator unrolled_list<T, Alloc, N>::nth(
+    size_t index) {
+  node* n = head;
+  while (n && index >= n->count) {
+    index -= n->count;
+    n = n->next;
+  }
+  return iterator(n, n ? index : 0, this);
+}
+
+}  // namespace task
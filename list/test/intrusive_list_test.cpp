@@ -0,0 +1,141 @@
+#include <iostream>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <vector>
+#include <list>
+#include "src/intrusive_list.h"
+
+
+size_t RandomUInt(size_t max = -1) {
+    static std::mt19937 rand(std::random_device{}());
+
+    std::uniform_int_distribution<size_t> dist{0, max};
+    return dist(rand);
+}
+
+
+void FailWithMsg(const std::string& msg, int line) {
+    std::cerr << "Test failed!\n";
+    std::cerr << "[Line " << line << "] "  << msg << std::endl;
+    std::exit(EXIT_FAILURE);
+}
+
+#define ASSERT_TRUE(cond) \
+    if (!(cond)) {FailWithMsg("Assertion failed: " #cond, __LINE__);};
+
+#define ASSERT_TRUE_MSG(cond, msg) \
+    if (!(cond)) {FailWithMsg(msg, __LINE__);};
+
+
+struct ByAge;
+struct ByName;
+
+struct Connection : task::intrusive_list_hook<ByAge>, task::intrusive_list_hook<ByName> {
+    size_t id;
+
+    explicit Connection(size_t id) : id(id) {}
+};
+
+using AgeList = task::intrusive_list<Connection, ByAge>;
+using NameList = task::intrusive_list<Connection, ByName>;
+
+
+template <class List>
+std::vector<size_t> Ids(const List& list) {
+    std::vector<size_t> result;
+    for (const auto& connection : list) {
+        result.push_back(connection.id);
+    }
+    return result;
+}
+
+
+int main() {
+
+    {
+        std::vector<Connection> connections;
+        for (size_t i = 0; i < 10; ++i) {
+            connections.emplace_back(i);
+        }
+
+        AgeList by_age;
+        NameList by_name;
+        for (auto& connection : connections) {
+            by_age.push_back(connection);
+            by_name.push_front(connection);
+        }
+
+        ASSERT_TRUE(by_age.size() == 10 && by_name.size() == 10)
+        ASSERT_TRUE(by_age.front().id == 0 && by_name.front().id == 9)
+        ASSERT_TRUE(&*AgeList::iterator_to(connections[3]) == &connections[3])
+
+        static_cast<task::intrusive_list_hook<ByAge>&>(connections[3]).unlink();
+        ASSERT_TRUE_MSG(by_age.size() == 9 && by_name.size() == 10, "Unlink from anywhere")
+        ASSERT_TRUE(std::find_if(by_age.begin(), by_age.end(),
+                                 [](const Connection& c) { return c.id == 3; }) == by_age.end())
+
+        by_age.erase(by_age.begin());
+        by_age.pop_back();
+        ASSERT_TRUE((Ids(by_age) == std::vector<size_t>{1, 2, 4, 5, 6, 7, 8}))
+
+        std::vector<size_t> reversed;
+        for (auto it = by_name.crbegin(); it != by_name.crend(); ++it) {
+            reversed.push_back(it->id);
+        }
+        ASSERT_TRUE_MSG((reversed == std::vector<size_t>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), "Reverse iterator")
+
+        AgeList other;
+        other.push_back(connections[3]);
+        other.splice(other.cbegin(), by_age);
+        ASSERT_TRUE_MSG(by_age.empty() && (Ids(other) == std::vector<size_t>{1, 2, 4, 5, 6, 7, 8, 3}), "Splice")
+
+        by_age.splice(by_age.cend(), AgeList::iterator_to(connections[5]));
+        ASSERT_TRUE_MSG(by_age.size() == 1 && other.size() == 7, "Splice element")
+
+        by_age.swap(other);
+        ASSERT_TRUE_MSG(by_age.size() == 7 && other.size() == 1 && other.front().id == 5, "Swap")
+
+        AgeList moved = std::move(by_age);
+        ASSERT_TRUE_MSG(by_age.empty() && moved.size() == 7 && moved.back().id == 3, "Move")
+
+        moved.clear();
+        ASSERT_TRUE(moved.empty() && !static_cast<task::intrusive_list_hook<ByAge>&>(connections[1]).is_linked())
+    }
+
+    {
+        NameList list;
+        {
+            Connection temporary(42);
+            list.push_back(temporary);
+            ASSERT_TRUE(list.size() == 1)
+        }
+        ASSERT_TRUE_MSG(list.empty(), "Auto unlink on destruction")
+    }
+
+    {
+        std::vector<Connection> connections;
+        std::list<size_t> list_std;
+        for (size_t i = 0; i < 1000; ++i) {
+            connections.emplace_back(i);
+        }
+
+        AgeList list;
+        for (auto& connection : connections) {
+            if (RandomUInt(1)) {
+                list.push_back(connection);
+                list_std.push_back(connection.id);
+            }
+        }
+        for (auto& connection : connections) {
+            if (RandomUInt(1)) {
+                static_cast<task::intrusive_list_hook<ByAge>&>(connection).unlink();
+                list_std.remove(connection.id);
+            }
+        }
+
+        auto ids = Ids(list);
+        ASSERT_TRUE_MSG(std::equal(ids.begin(), ids.end(), list_std.begin(), list_std.end()), "Stress test")
+    }
+
+}
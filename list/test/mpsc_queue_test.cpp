@@ -0,0 +1,83 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <memory>
+#include "src/mpsc_queue.h"
+
+
+void FailWithMsg(const std::string& msg, int line) {
+    std::cerr << "Test failed!\n";
+    std::cerr << "[Line " << line << "] "  << msg << std::endl;
+    std::exit(EXIT_FAILURE);
+}
+
+#define ASSERT_TRUE(cond) \
+    if (!(cond)) {FailWithMsg("Assertion failed: " #cond, __LINE__);};
+
+#define ASSERT_TRUE_MSG(cond, msg) \
+    if (!(cond)) {FailWithMsg(msg, __LINE__);};
+
+
+int main() {
+
+    {
+        task::mpsc_queue<std::string> queue;
+        ASSERT_TRUE(queue.empty())
+
+        std::string value;
+        ASSERT_TRUE(!queue.try_pop(value))
+
+        queue.push("first");
+        queue.emplace(3, 'x');
+        ASSERT_TRUE(!queue.empty())
+        ASSERT_TRUE(queue.try_pop(value) && value == "first")
+        ASSERT_TRUE(queue.try_pop(value) && value == "xxx")
+        ASSERT_TRUE(queue.empty())
+
+        // Left for the destructor.
+        queue.push("leftover");
+    }
+
+    {
+        task::mpsc_queue<std::unique_ptr<int>> queue;
+        queue.push(std::make_unique<int>(42));
+
+        std::unique_ptr<int> value;
+        ASSERT_TRUE_MSG(queue.try_pop(value) && *value == 42, "Move-only payload")
+    }
+
+    {
+        const size_t PRODUCER_COUNT = 8;
+        const size_t ITEM_COUNT = 100000;
+
+        task::mpsc_queue<std::pair<size_t, size_t>> queue;
+        std::vector<std::thread> producers;
+        for (size_t p = 0; p < PRODUCER_COUNT; ++p) {
+            producers.emplace_back([&queue, p] {
+                for (size_t i = 0; i < ITEM_COUNT; ++i) {
+                    queue.emplace(p, i);
+                }
+            });
+        }
+
+        std::vector<size_t> expected(PRODUCER_COUNT, 0);
+        size_t popped = 0;
+        std::pair<size_t, size_t> value;
+        while (popped < PRODUCER_COUNT * ITEM_COUNT) {
+            if (!queue.try_pop(value)) {
+                std::this_thread::yield();
+                continue;
+            }
+            ASSERT_TRUE_MSG(value.second == expected[value.first], "Per-producer FIFO order")
+            ++expected[value.first];
+            ++popped;
+        }
+
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        ASSERT_TRUE(queue.empty())
+    }
+
+}
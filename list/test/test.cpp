@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <vector>
 #include <list>
+#include <stdexcept>
 #include "src/list.h"
 
 
@@ -62,6 +63,91 @@ struct ArgForwardTester {
 };
 
 
+struct AllocStats {
+    size_t allocations = 0;
+    size_t deallocations = 0;
+} alloc_stats;
+
+// std::allocator that counts the calls made through any of its rebound
+// copies in alloc_stats.
+template <class T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template <class U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        ++alloc_stats.allocations;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) {
+        ++alloc_stats.deallocations;
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    bool operator==(const CountingAllocator&) const {
+        return true;
+    }
+    bool operator!=(const CountingAllocator&) const {
+        return false;
+    }
+};
+
+// Serves one element at a time, like a pool of fixed-size blocks, and
+// throws std::bad_alloc for anything larger.
+template <class T>
+struct SingleElementAllocator {
+    using value_type = T;
+
+    SingleElementAllocator() = default;
+    template <class U>
+    SingleElementAllocator(const SingleElementAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        if (n > 1) {
+            throw std::bad_alloc();
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    bool operator==(const SingleElementAllocator&) const {
+        return true;
+    }
+    bool operator!=(const SingleElementAllocator&) const {
+        return false;
+    }
+};
+
+// Less-than that throws once calls_left comparisons have been made.
+struct ThrowingLess {
+    size_t* calls_left;
+
+    bool operator()(size_t a, size_t b) const {
+        if ((*calls_left)-- == 0) {
+            throw std::runtime_error("comparison failed");
+        }
+        return a < b;
+    }
+};
+
+// Walking the list backwards must visit the same elements as walking it
+// forwards, and both must agree with size().
+template <class List>
+bool LinksAreConsistent(const List& list) {
+    std::vector<typename List::value_type> forward(list.begin(), list.end());
+    std::vector<typename List::value_type> backward(list.crbegin(), list.crend());
+    std::reverse(backward.begin(), backward.end());
+    return forward.size() == list.size() && forward == backward;
+}
+
+
 void FailWithMsg(const std::string& msg, int line) {
     std::cerr << "Test failed!\n";
     std::cerr << "[Line " << line << "] "  << msg << std::endl;
@@ -193,6 +279,411 @@ int main() {
     }
 
 
+    {
+        task::list<size_t> list_task;
+        std::list<size_t> list_std;
+
+        RandomFill(list_std, RandomUInt(100000, 200000), 1000);
+        list_task.assign(list_std.begin(), list_std.end());
+
+        list_task.sort(task::execution::par);
+        list_std.sort();
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::sort(par)")
+
+        list_task.sort(task::execution::par, std::greater<size_t>());
+        list_std.sort(std::greater<size_t>());
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::sort(par, comp)")
+
+        // The comparator may throw on any of the sorting threads.
+        list_task.push_back(500);
+        std::vector<size_t> elements(list_task.begin(), list_task.end());
+        std::sort(elements.begin(), elements.end());
+        bool thrown = false;
+        try {
+            list_task.sort(task::execution::par, [](size_t a, size_t b) {
+                if (a == 500 || b == 500) {
+                    throw std::runtime_error("comparison failed");
+                }
+                return a < b;
+            });
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        ASSERT_TRUE_MSG(thrown, "list::sort(par, comp) with a throwing comparator")
+        ASSERT_TRUE_MSG(LinksAreConsistent(list_task), "list::sort(par, comp) with a throwing comparator")
+        std::vector<size_t> after(list_task.begin(), list_task.end());
+        std::sort(after.begin(), after.end());
+        ASSERT_TRUE_MSG(after == elements, "list::sort(par, comp) with a throwing comparator")
+    }
+
+
+    {
+        task::list<size_t> list_task;
+        std::list<size_t> list_std;
+
+        RandomFill(list_std, RandomUInt(1000, 5000), 1000);
+        list_task.assign(list_std.begin(), list_std.end());
+
+        // Comparing by the hundreds only leaves many ties, which stay in
+        // their original order.
+        auto by_hundreds = [](size_t a, size_t b) { return a / 100 < b / 100; };
+        list_task.sort(by_hundreds);
+        list_std.sort(by_hundreds);
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::sort(comp)")
+        ASSERT_TRUE_MSG(LinksAreConsistent(list_task), "list::sort(comp)")
+
+        std::vector<size_t> elements(list_task.begin(), list_task.end());
+        std::sort(elements.begin(), elements.end());
+        for (size_t calls : {size_t(0), size_t(1), RandomUInt(2, list_task.size())}) {
+            bool thrown = false;
+            try {
+                list_task.sort(ThrowingLess{&calls});
+            } catch (const std::runtime_error&) {
+                thrown = true;
+            }
+            ASSERT_TRUE_MSG(thrown, "list::sort(comp) with a throwing comparator")
+
+            std::vector<size_t> after(list_task.begin(), list_task.end());
+            std::sort(after.begin(), after.end());
+            ASSERT_TRUE_MSG(after == elements, "list::sort(comp) with a throwing comparator")
+            ASSERT_TRUE_MSG(LinksAreConsistent(list_task), "list::sort(comp) with a throwing comparator")
+        }
+    }
+
+
+    {
+        task::list<size_t> list_task, list_task2;
+        std::list<size_t> list_std, list_std2;
+
+        RandomFill(list_std, RandomUInt(100, 500), 1000);
+        RandomFill(list_std2, RandomUInt(100, 500), 1000);
+        list_task.assign(list_std.begin(), list_std.end());
+        list_task2.assign(list_std2.begin(), list_std2.end());
+
+        auto& element_reference = list_task2.front();
+        list_task.splice(std::next(list_task.begin()), list_task2, list_task2.begin());
+        list_std.splice(std::next(list_std.begin()), list_std2, list_std2.begin());
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::splice(pos, other, it)")
+        ASSERT_EQUAL_MSG(list_task2, list_std2, "list::splice(pos, other, it)")
+        ASSERT_TRUE_MSG(&element_reference == &*std::next(list_task.begin()), "list::splice(pos, other, it)")
+
+        list_task.splice(list_task.end(), list_task, list_task.begin());
+        list_std.splice(list_std.end(), list_std, list_std.begin());
+        list_task.splice(list_task.begin(), list_task, std::prev(list_task.end()));
+        list_std.splice(list_std.begin(), list_std, std::prev(list_std.end()));
+        list_task.splice(list_task.begin(), list_task, list_task.begin());
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::splice(pos, this, it)")
+        ASSERT_TRUE_MSG(LinksAreConsistent(list_task), "list::splice(pos, this, it)")
+
+        size_t from = RandomUInt(list_std2.size() / 2);
+        size_t to = RandomUInt(from, list_std2.size());
+        list_task.splice(std::next(list_task.begin(), 3), list_task2,
+                         std::next(list_task2.begin(), from), std::next(list_task2.begin(), to));
+        list_std.splice(std::next(list_std.begin(), 3), list_std2,
+                        std::next(list_std2.begin(), from), std::next(list_std2.begin(), to));
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::splice(pos, other, first, last)")
+        ASSERT_EQUAL_MSG(list_task2, list_std2, "list::splice(pos, other, first, last)")
+        ASSERT_TRUE_MSG(list_task.size() == list_std.size(), "list::splice(pos, other, first, last)")
+        ASSERT_TRUE_MSG(list_task2.size() == list_std2.size(), "list::splice(pos, other, first, last)")
+
+        list_task.splice(list_task.begin(), list_task, std::next(list_task.begin(), 10), list_task.end());
+        list_std.splice(list_std.begin(), list_std, std::next(list_std.begin(), 10), list_std.end());
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::splice(pos, this, first, last)")
+        ASSERT_TRUE_MSG(list_task.size() == list_std.size(), "list::splice(pos, this, first, last)")
+
+        list_task.splice(list_task.end(), list_task2, list_task2.begin(), list_task2.end(), list_task2.size());
+        list_std.splice(list_std.end(), list_std2);
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::splice(pos, other, first, last, count)")
+        ASSERT_TRUE_MSG(list_task2.empty(), "list::splice(pos, other, first, last, count)")
+        ASSERT_TRUE_MSG(LinksAreConsistent(list_task), "list::splice(pos, other, first, last, count)")
+        ASSERT_TRUE_MSG(LinksAreConsistent(list_task2), "list::splice(pos, other, first, last, count)")
+    }
+
+
+    {
+        task::list<size_t> list_task, list_task2;
+        std::list<size_t> list_std, list_std2;
+
+        RandomFill(list_std, RandomUInt(100, 500), 1000);
+        RandomFill(list_std2, RandomUInt(100, 500), 1000);
+        list_std.sort(std::greater<size_t>());
+        list_std2.sort(std::greater<size_t>());
+        list_task.assign(list_std.begin(), list_std.end());
+        list_task2.assign(list_std2.begin(), list_std2.end());
+
+        list_task.merge(list_task2, std::greater<size_t>());
+        list_std.merge(list_std2, std::greater<size_t>());
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::merge(other, comp)")
+        ASSERT_TRUE_MSG(list_task2.empty(), "list::merge(other, comp)")
+        ASSERT_TRUE_MSG(LinksAreConsistent(list_task), "list::merge(other, comp)")
+
+        std::vector<size_t> elements(list_task.rbegin(), list_task.rend());
+        for (size_t calls : {size_t(0), RandomUInt(1, elements.size())}) {
+            list_task.assign(elements.begin(), elements.end());
+            list_task2.assign(elements.begin(), elements.end());
+
+            bool thrown = false;
+            try {
+                list_task.merge(list_task2, ThrowingLess{&calls});
+            } catch (const std::runtime_error&) {
+                thrown = true;
+            }
+            ASSERT_TRUE_MSG(thrown, "list::merge(other, comp) with a throwing comparator")
+            ASSERT_TRUE_MSG(LinksAreConsistent(list_task), "list::merge(other, comp) with a throwing comparator")
+            ASSERT_TRUE_MSG(LinksAreConsistent(list_task2), "list::merge(other, comp) with a throwing comparator")
+            ASSERT_TRUE_MSG(!list_task2.empty(), "list::merge(other, comp) with a throwing comparator")
+
+            // Every element is still in exactly one of the lists.
+            std::vector<size_t> after(list_task.begin(), list_task.end());
+            after.insert(after.end(), list_task2.begin(), list_task2.end());
+            std::sort(after.begin(), after.end());
+            std::vector<size_t> expected;
+            for (size_t item : elements) {
+                expected.insert(expected.end(), 2, item);
+            }
+            ASSERT_TRUE_MSG(after == expected, "list::merge(other, comp) with a throwing comparator")
+        }
+    }
+
+
+    {
+        task::list<size_t> list_task;
+        std::list<size_t> list_std;
+
+        RandomFill(list_std, RandomUInt(1000, 5000), 100);
+        list_task.assign(list_std.begin(), list_std.end());
+
+        size_t size = list_std.size();
+        auto is_odd = [](size_t item) { return item % 2 == 1; };
+        size_t removed = list_task.remove_if(is_odd);
+        list_std.remove_if(is_odd);
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::remove_if")
+        ASSERT_TRUE_MSG(removed == size - list_std.size(), "list::remove_if count")
+        ASSERT_TRUE_MSG(list_task.size() == list_std.size(), "list::remove_if")
+        ASSERT_TRUE_MSG(list_task.remove_if(is_odd) == 0, "list::remove_if count")
+
+        // Consecutive elements in the same ten are duplicates.
+        size = list_std.size();
+        auto same_ten = [](size_t a, size_t b) { return a / 10 == b / 10; };
+        removed = list_task.unique(same_ten);
+        list_std.unique(same_ten);
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::unique(pred)")
+        ASSERT_TRUE_MSG(removed == size - list_std.size(), "list::unique(pred) count")
+        ASSERT_TRUE_MSG(LinksAreConsistent(list_task), "list::unique(pred)")
+
+        ASSERT_TRUE_MSG(list_task.remove_if([](size_t) { return true; }) == list_std.size(), "list::remove_if count")
+        ASSERT_TRUE_MSG(list_task.empty(), "list::remove_if")
+        ASSERT_TRUE_MSG(list_task.unique(same_ten) == 0, "list::unique(pred) count")
+    }
+
+
+    {
+        std::vector<size_t> values;
+        RandomFill(values, RandomUInt(100, 500));
+
+        task::list<size_t, SingleElementAllocator<size_t>> list(values.begin(), values.end());
+        ASSERT_EQUAL_MSG(list, values, "Construction with an allocator refusing slabs")
+        list.assign(values.size() * 2, 42);
+        ASSERT_TRUE_MSG(list.size() == values.size() * 2 && list.back() == 42, "list::assign with an allocator refusing slabs")
+        list.insert(list.begin(), values.begin(), values.end());
+        ASSERT_TRUE_MSG(std::equal(values.begin(), values.end(), list.begin()), "list::insert with an allocator refusing slabs")
+        ASSERT_TRUE_MSG(LinksAreConsistent(list), "list::insert with an allocator refusing slabs")
+    }
+
+
+    {
+        // Nodes of one slab end up in two lists; the slab must outlive the
+        // list it was allocated by.
+        std::vector<size_t> values;
+        RandomFill(values, RandomUInt(100, 500));
+
+        task::list<size_t> destination;
+        {
+            task::list<size_t> source(values.begin(), values.end());
+            auto middle = std::next(source.begin(), values.size() / 2);
+            destination.splice(destination.end(), source, middle, source.end());
+            destination.splice(destination.begin(), source, source.begin());
+        }
+        std::vector<size_t> expected(values.begin() + values.size() / 2, values.end());
+        expected.insert(expected.begin(), values.front());
+        ASSERT_EQUAL_MSG(destination, expected, "Splice out of a slab")
+
+        destination.push_back(1);
+        destination.pop_front();
+        expected.erase(expected.begin());
+        expected.push_back(1);
+        ASSERT_EQUAL_MSG(destination, expected, "Splice out of a slab")
+    }
+
+
+    {
+        alloc_stats = AllocStats();
+        {
+            task::list<size_t, CountingAllocator<size_t>> list;
+            for (size_t i = 0; i < 20; ++i) {
+                list.push_back(i);
+            }
+            ASSERT_TRUE_MSG(alloc_stats.allocations == 20, "Allocation through the rebound allocator")
+
+            list.set_node_cache_limit(8);
+            list.clear();
+            ASSERT_TRUE_MSG(list.node_cache_size() == 8, "list::set_node_cache_limit")
+            ASSERT_TRUE_MSG(alloc_stats.deallocations == 12, "list::set_node_cache_limit")
+
+            for (size_t i = 0; i < 5; ++i) {
+                list.push_front(i);
+            }
+            ASSERT_TRUE_MSG(alloc_stats.allocations == 20, "Insertion reuses cached nodes")
+            ASSERT_TRUE_MSG(list.node_cache_size() == 3, "Insertion reuses cached nodes")
+
+            list.pop_back();
+            list.set_node_cache_limit(2);
+            ASSERT_TRUE_MSG(list.node_cache_size() == 2, "list::set_node_cache_limit")
+
+            list.shrink_node_cache();
+            ASSERT_TRUE_MSG(list.node_cache_size() == 0, "list::shrink_node_cache")
+            ASSERT_TRUE_MSG(alloc_stats.deallocations == 16, "list::shrink_node_cache")
+
+            // The limit survives shrinking.
+            list.pop_front();
+            ASSERT_TRUE_MSG(list.node_cache_size() == 1, "list::shrink_node_cache")
+        }
+        ASSERT_TRUE_MSG(alloc_stats.allocations == alloc_stats.deallocations, "Allocation through the rebound allocator")
+    }
+
+
+    {
+        using counted_list = task::list<size_t, CountingAllocator<size_t>>;
+        std::vector<size_t> values, values2;
+        RandomFill(values, RandomUInt(100, 500));
+        RandomFill(values2, values.size());
+
+        counted_list list(values.begin(), values.end());
+        counted_list list2(values2.begin(), values2.end());
+        counted_list shorter(values.begin(), values.begin() + values.size() / 2);
+
+        // Equal lengths: every element is assigned in place.
+        size_t allocations = alloc_stats.allocations;
+        size_t deallocations = alloc_stats.deallocations;
+        list = list2;
+        ASSERT_EQUAL_MSG(list, values2, "Assignment operator")
+        ASSERT_TRUE_MSG(alloc_stats.allocations == allocations, "Assignment of equal length allocates nothing")
+        ASSERT_TRUE_MSG(alloc_stats.deallocations == deallocations, "Assignment of equal length frees nothing")
+
+        list2 = counted_list(values.begin(), values.end());
+        allocations = alloc_stats.allocations;
+        list = list2;
+        ASSERT_EQUAL_MSG(list, values, "Assignment operator")
+        ASSERT_TRUE_MSG(alloc_stats.allocations == allocations, "Assignment of equal length allocates nothing")
+
+        // A shorter source only frees the surplus nodes, a longer one only
+        // allocates the missing ones.
+        list = shorter;
+        ASSERT_EQUAL_MSG(list, shorter, "Assignment operator")
+        ASSERT_TRUE_MSG(alloc_stats.allocations == allocations, "Assignment of a shorter list allocates nothing")
+        ASSERT_TRUE_MSG(LinksAreConsistent(list), "Assignment operator")
+
+        list = list2;
+        ASSERT_EQUAL_MSG(list, values, "Assignment operator")
+        ASSERT_TRUE_MSG(alloc_stats.allocations == allocations + 2, "Assignment of a longer list allocates one slab and its header")
+        ASSERT_TRUE_MSG(LinksAreConsistent(list), "Assignment operator")
+    }
+
+
+    {
+        using counted_list = task::list<size_t, CountingAllocator<size_t>>;
+        std::vector<size_t> values;
+        RandomFill(values, RandomUInt(100, 200));
+
+        counted_list list(values.size(), 7);
+        size_t allocations = alloc_stats.allocations;
+        size_t deallocations = alloc_stats.deallocations;
+        list.assign(values.begin(), values.end());
+        ASSERT_EQUAL_MSG(list, values, "list::assign")
+        ASSERT_TRUE_MSG(alloc_stats.allocations == allocations && alloc_stats.deallocations == deallocations,
+                        "list::assign of equal length reuses every node")
+
+        list.assign(values.size() / 2, list.back());
+        ASSERT_TRUE_MSG(list.size() == values.size() / 2 && list.front() == values.back() &&
+                        list.back() == values.back(), "list::assign from an element of the list")
+        ASSERT_TRUE_MSG(alloc_stats.allocations == allocations, "list::assign of a shorter length allocates nothing")
+        ASSERT_TRUE_MSG(LinksAreConsistent(list), "list::assign")
+
+        list.assign(values.begin(), values.end());
+        ASSERT_EQUAL_MSG(list, values, "list::assign")
+        ASSERT_TRUE_MSG(alloc_stats.allocations == allocations + 2, "list::assign of a longer range allocates one slab and its header")
+        ASSERT_TRUE_MSG(LinksAreConsistent(list), "list::assign")
+    }
+
+
+    {
+        // Slabs are bounded, so a surviving node only keeps its own slab.
+        alloc_stats = AllocStats();
+        task::list<size_t, CountingAllocator<size_t>> list(1000, 3);
+        ASSERT_TRUE_MSG(alloc_stats.allocations == 8, "Construction allocates bounded slabs")
+
+        list.erase(std::next(list.begin()), list.end());
+        ASSERT_TRUE_MSG(list.size() == 1 && LinksAreConsistent(list), "list::erase")
+        ASSERT_TRUE_MSG(alloc_stats.deallocations == 6, "A surviving node keeps only its own slab")
+    }
+
+
+    {
+        std::pmr::monotonic_buffer_resource resource;
+        task::pmr::list<size_t> list_task(&resource);
+        std::list<size_t> list_std;
+
+        RandomFill(list_std, RandomUInt(1000, 2000));
+        list_task.assign(list_std.begin(), list_std.end());
+        list_task.push_front(1);
+        list_std.push_front(1);
+
+        task::pmr::list<size_t> copy(list_task);
+        copy.sort();
+        list_std.sort();
+        ASSERT_EQUAL_MSG(copy, list_std, "pmr::list")
+    }
+
+
+    {
+        // polymorphic_allocator never propagates: moves and swaps keep each
+        // list on its own resource.
+        std::pmr::monotonic_buffer_resource resource;
+        std::pmr::unsynchronized_pool_resource other_resource;
+        std::vector<size_t> values, values2;
+        RandomFill(values, RandomUInt(100, 500));
+        RandomFill(values2, RandomUInt(100, 500));
+
+        task::pmr::list<size_t> source(values.begin(), values.end(), &resource);
+        const size_t* first = &source.front();
+        task::pmr::list<size_t> list(std::move(source));
+        ASSERT_TRUE_MSG(list.get_allocator().resource() == &resource && &list.front() == first,
+                        "pmr::list move constructor")
+        ASSERT_TRUE_MSG(source.empty() && source.get_allocator().resource() == &resource,
+                        "pmr::list move constructor")
+
+        task::pmr::list<size_t> list2(values2.begin(), values2.end(), &resource);
+        list.swap(list2);
+        ASSERT_EQUAL_MSG(list, values2, "pmr::list swap")
+        ASSERT_EQUAL_MSG(list2, values, "pmr::list swap")
+        ASSERT_TRUE_MSG(&list2.front() == first, "pmr::list swap")
+
+        // Equal resources: the nodes change hands.
+        list = std::move(list2);
+        ASSERT_EQUAL_MSG(list, values, "pmr::list move assignment")
+        ASSERT_TRUE_MSG(&list.front() == first && list2.empty(), "pmr::list move assignment")
+
+        // Different resources: the elements are moved into nodes of the
+        // target's resource.
+        task::pmr::list<size_t> other(&other_resource);
+        other = std::move(list);
+        ASSERT_EQUAL_MSG(other, values, "pmr::list move assignment")
+        ASSERT_TRUE_MSG(other.get_allocator().resource() == &other_resource && &other.front() != first,
+                        "pmr::list move assignment")
+        ASSERT_TRUE_MSG(LinksAreConsistent(other), "pmr::list move assignment")
+    }
+
+
     {
         task::list<size_t> list_task;
         std::list<size_t> list_std;
@@ -0,0 +1,248 @@
+#include <iostream>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <vector>
+#include <list>
+#include <stdexcept>
+#include "src/unrolled_list.h"
+
+
+size_t RandomUInt(size_t max = -1) {
+    static std::mt19937 rand(std::random_device{}());
+
+    std::uniform_int_distribution<size_t> dist{0, max};
+    return dist(rand);
+}
+
+size_t RandomUInt(size_t min, size_t max) {
+    return min + RandomUInt(max - min);
+}
+
+bool TossCoin() {
+    return RandomUInt(1) == 0;
+}
+
+
+template <class T>
+void RandomFill(T& container, size_t count, size_t max = -1) {
+    while (count > 0) {
+        container.push_back(RandomUInt(max));
+        --count;
+    }
+}
+
+
+void FailWithMsg(const std::string& msg, int line) {
+    std::cerr << "Test failed!\n";
+    std::cerr << "[Line " << line << "] "  << msg << std::endl;
+    std::exit(EXIT_FAILURE);
+}
+
+#define ASSERT_TRUE(cond) \
+    if (!(cond)) {FailWithMsg("Assertion failed: " #cond, __LINE__);};
+
+#define ASSERT_TRUE_MSG(cond, msg) \
+    if (!(cond)) {FailWithMsg(msg, __LINE__);};
+
+#define ASSERT_EQUAL_MSG(cont1, cont2, msg) \
+    ASSERT_TRUE_MSG(std::equal(cont1.begin(), cont1.end(), cont2.begin(), cont2.end()), msg)
+
+
+template <size_t NodeCapacity>
+void StressTest() {
+    using unrolled = task::unrolled_list<size_t, std::allocator<size_t>, NodeCapacity>;
+
+    const size_t ITER_COUNT = 5000;
+
+    unrolled list_task, list_task2;
+    std::list<size_t> list_std, list_std2;
+
+    for (size_t iter = 0; iter < ITER_COUNT; ++iter) {
+        size_t pos = RandomUInt(list_std.size());
+        auto it_task = std::next(list_task.begin(), pos);
+        auto it_std = std::next(list_std.begin(), pos);
+        size_t val = RandomUInt(20);
+
+        switch (RandomUInt(9)) {
+            case 0:
+                list_task.insert(it_task, val);
+                list_std.insert(it_std, val);
+                break;
+            case 1: {
+                size_t count = RandomUInt(2 * NodeCapacity);
+                list_task.insert(it_task, count, val);
+                list_std.insert(it_std, count, val);
+                break;
+            }
+            case 2:
+                if (pos < list_std.size()) {
+                    auto result = list_task.erase(it_task);
+                    list_std.erase(it_std);
+                    ASSERT_TRUE_MSG(static_cast<size_t>(std::distance(list_task.begin(), result)) == pos, "unrolled_list::erase")
+                }
+                break;
+            case 3: {
+                size_t last = pos + RandomUInt(list_std.size() - pos);
+                list_task.erase(it_task, std::next(list_task.begin(), last));
+                list_std.erase(it_std, std::next(list_std.begin(), last));
+                break;
+            }
+            case 4:
+                if (TossCoin()) {
+                    list_task.push_front(val);
+                    list_std.push_front(val);
+                } else if (!list_std.empty()) {
+                    list_task.pop_back();
+                    list_std.pop_back();
+                }
+                break;
+            case 5:
+                list_task.reverse();
+                list_std.reverse();
+                break;
+            case 6:
+                list_task.sort();
+                list_std.sort();
+                list_task.unique();
+                list_std.unique();
+                break;
+            case 7:
+                if (!list_std.empty()) {
+                    list_task.remove(list_task.back());
+                    list_std.remove(list_std.back());
+                }
+                break;
+            case 8:
+                RandomFill(list_task2, RandomUInt(3 * NodeCapacity), 20);
+                list_std2.assign(list_task2.begin(), list_task2.end());
+                if (TossCoin()) {
+                    list_task.splice(it_task, list_task2);
+                    list_std.splice(it_std, list_std2);
+                } else {
+                    list_task.sort();
+                    list_std.sort();
+                    list_task2.sort();
+                    list_std2.sort();
+                    list_task.merge(list_task2);
+                    list_std.merge(list_std2);
+                }
+                ASSERT_TRUE_MSG(list_task2.empty(), "unrolled_list::splice / merge")
+                break;
+            case 9:
+                if (!list_std.empty()) {
+                    size_t first = RandomUInt(list_std.size() - 1);
+                    size_t last = first + RandomUInt(list_std.size() - first);
+                    if (pos < first || pos > last) {
+                        list_task.splice(it_task, list_task, std::next(list_task.begin(), first),
+                                         std::next(list_task.begin(), last));
+                        list_std.splice(it_std, list_std, std::next(list_std.begin(), first),
+                                        std::next(list_std.begin(), last));
+                    }
+                }
+                break;
+        }
+
+        ASSERT_TRUE(list_task.size() == list_std.size())
+        ASSERT_EQUAL_MSG(list_task, list_std, "Stress test")
+        ASSERT_TRUE_MSG(std::equal(list_task.crbegin(), list_task.crend(), list_std.rbegin(), list_std.rend()),
+                        "Stress test / const reverse iterator")
+    }
+}
+
+
+int main() {
+
+    {
+        task::unrolled_list<std::string> list(3);
+        list.push_back("test");
+        list.push_front("test2");
+        ASSERT_TRUE(list.size() == 5)
+        ASSERT_TRUE(list.front() == "test2" && list.back() == "test")
+
+        list.insert(std::next(list.begin(), 2), list.back());
+        ASSERT_TRUE(*std::next(list.begin(), 2) == "test")
+
+        task::unrolled_list<std::string> list2 = list;
+        ASSERT_EQUAL_MSG(list, list2, "Copy constructor")
+
+        list.clear();
+        list = std::move(list2);
+        ASSERT_TRUE(list.size() == 6 && list2.empty())
+
+        list.resize(2);
+        ASSERT_TRUE(list.size() == 2 && list.back() == "")
+    }
+
+    {
+        task::unrolled_list<size_t> list_task(1000, 30);
+        std::list<size_t> list_std(1000, 30);
+        ASSERT_EQUAL_MSG(list_task, list_std, "Count-value constructor")
+
+        std::copy(list_std.begin(), list_std.end(), list_task.begin());
+        list_task.sort();
+        ASSERT_TRUE(std::is_sorted(list_task.begin(), list_task.end()))
+    }
+
+    {
+        struct Explosive {
+            explicit Explosive(int value) : value(value) {
+                if (value < 0) {
+                    throw std::runtime_error("negative");
+                }
+            }
+            int value;
+        };
+
+        task::unrolled_list<Explosive, std::allocator<Explosive>, 4> list;
+        bool thrown = false;
+        try {
+            list.emplace_back(-1);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        ASSERT_TRUE_MSG(thrown && list.empty() && list.begin() == list.end(), "Throwing emplace into an empty list")
+
+        for (int i = 0; i < 4; ++i) {
+            list.emplace_back(i);
+        }
+        thrown = false;
+        try {
+            list.emplace_back(-1);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        list.emplace_back(4);
+        ASSERT_TRUE_MSG(thrown && list.size() == 5 && std::distance(list.begin(), list.end()) == 5 &&
+                        list.back().value == 4, "Throwing emplace into a new node")
+    }
+
+    {
+        task::unrolled_list<std::string, std::allocator<std::string>, 8> list_task;
+        for (size_t i = 0; i < 100; ++i) {
+            list_task.push_back(std::to_string(RandomUInt()));
+        }
+        const std::list<std::string> list_std(list_task.begin(), list_task.end());
+
+        size_t calls = 0;
+        bool thrown = false;
+        try {
+            list_task.sort([&calls](const std::string& lhs, const std::string& rhs) {
+                if (++calls == 200) {
+                    throw std::runtime_error("comparator");
+                }
+                return lhs < rhs;
+            });
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        ASSERT_TRUE(thrown)
+        ASSERT_EQUAL_MSG(list_task, list_std, "Throwing comparator leaves the list unchanged")
+    }
+
+    StressTest<2>();
+    StressTest<3>();
+    StressTest<8>();
+    StressTest<64>();
+
+}
@@ -0,0 +1,10 @@
+#!/bin/bash
+
+set -e
+
+MAX_SIZE=100000000
+
+g++ -std=c++17 -O2 -march=native -pthread -I./ bench/bench.cpp -o vector_ops_bench
+./vector_ops_bench $MAX_SIZE
+
+rm vector_ops_bench
@@ -0,0 +1,316 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "src/vector_ops.h"
+#include "src/bit_vector.h"
+#include "src/vec.h"
+
+
+using namespace task;
+
+
+// Every measured call runs at least this many elements in total, so short
+// vectors are repeated until the timing is meaningful.
+const size_t ELEMENTS_PER_MEASUREMENT = 20000000;
+
+// Text holds ~20 bytes per element, so I/O stops at this size to keep the
+// serialized copies in memory.
+const size_t MAX_IO_SIZE = 10000000;
+
+// The std::vector<double> column allocates every three-dimensional vector
+// separately, so the fixed-size comparison stops at this size whatever the
+// sweep's upper bound.
+const size_t MAX_FIXED_SIZE = 1000000;
+
+volatile double sink;
+
+
+double RandomDouble() {
+    static std::mt19937 rand(42);
+
+    std::uniform_real_distribution<double> dist{-10., 10.};
+    return dist(rand);
+}
+
+// Values spanning many orders of magnitude, so that the order of summation
+// actually matters for the dot product.
+double RandomWideDouble() {
+    static std::mt19937 rand(4242);
+
+    std::uniform_real_distribution<double> exponent{-8., 8.};
+    return RandomDouble() * std::pow(10., exponent(rand));
+}
+
+int RandomFlag() {
+    static std::mt19937 rand(424242);
+
+    return rand() & 1;
+}
+
+
+template <class F>
+double SecondsPerCall(F f, size_t n) {
+    size_t repeats = std::max<size_t>(1, ELEMENTS_PER_MEASUREMENT / std::max<size_t>(n, 1));
+
+    if (repeats > 1) {
+        f();
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repeats; ++i) {
+        f();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats;
+}
+
+template <class F>
+void Bench(const char* op, const char* variant, size_t n, F f) {
+    double seconds = SecondsPerCall(f, n);
+    std::printf("%-14s %-10s %11zu %12.2f Melem/s %14.1f ns/call\n",
+                op, variant, n, n / seconds / 1e6, seconds * 1e9);
+}
+
+
+void BenchDoubles(size_t n) {
+    std::vector<double> a(n), b(n);
+    std::generate(a.begin(), a.end(), RandomDouble);
+    b = a;
+    for (auto& item : b) {
+        item *= 2.;
+    }
+
+    Bench("binary +", "scalar", n, [&] { sink = (a + b)[0]; });
+    Bench("binary -", "scalar", n, [&] { sink = (a - b)[0]; });
+    Bench("unary +", "scalar", n, [&] { sink = (+a)[0]; });
+    Bench("unary -", "scalar", n, [&] { sink = (-a)[0]; });
+    Bench("dot *", "scalar", n, [&] { sink = a * b; });
+    Bench("dot *", "parallel", n, [&] { sink = parallel_dot(a, b); });
+    Bench("collinear ||", "scalar", n, [&] { sink = a || b; });
+    Bench("codirect &&", "scalar", n, [&] { sink = a && b; });
+    Bench("reverse", "scalar", n, [&] { reverse(a); sink = a[0]; });
+
+    std::vector<double> zeros(n, 0.);
+    Bench("zero check", "scalar", n, [&] { sink = check_if_zero(zeros); });
+    Bench("zero check", "parallel", n, [&] { sink = parallel_check_if_zero(zeros); });
+}
+
+void BenchCross(size_t n) {
+    // n doubles in total, i.e. n / 3 three-dimensional vectors.
+    size_t count = std::max<size_t>(1, n / 3);
+    std::vector<double> lx(count), ly(count), lz(count), rx(count), ry(count), rz(count);
+    for (auto* component : {&lx, &ly, &lz, &rx, &ry, &rz}) {
+        std::generate(component->begin(), component->end(), RandomDouble);
+    }
+    std::vector<double> ox(count), oy(count), oz(count);
+
+    Bench("cross %", "scalar", count * 3, [&] {
+        for (size_t i = 0; i < count; ++i) {
+            auto cross = std::vector<double>{lx[i], ly[i], lz[i]} % std::vector<double>{rx[i], ry[i], rz[i]};
+            ox[i] = cross[0];
+        }
+        sink = ox[0];
+    });
+    Bench("cross %", "simd", count * 3, [&] {
+        cross_batch(lx.data(), ly.data(), lz.data(), rx.data(), ry.data(), rz.data(),
+                    ox.data(), oy.data(), oz.data(), count);
+        sink = ox[0];
+    });
+}
+
+void BenchFixed(size_t n) {
+    if (n > MAX_FIXED_SIZE) {
+        return;
+    }
+    // n doubles in total, i.e. n / 3 three-dimensional vectors, once as
+    // Vec<3> and once as std::vector<double> of size 3.
+    size_t count = std::max<size_t>(1, n / 3);
+    std::vector<Vec<3>> a(count), b(count), out(count);
+    std::vector<std::vector<double>> va(count), vb(count);
+    for (size_t i = 0; i < count; ++i) {
+        a[i] = Vec<3>(RandomDouble(), RandomDouble(), RandomDouble());
+        b[i] = a[i] + a[i];
+        va[i] = a[i].to_vector();
+        vb[i] = b[i].to_vector();
+    }
+
+    Bench("binary +", "vec3", count * 3, [&] {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = a[i] + b[i];
+        }
+        sink = out[0][0];
+    });
+    Bench("binary -", "vec3", count * 3, [&] {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = a[i] - b[i];
+        }
+        sink = out[0][0];
+    });
+    Bench("unary +", "vec3", count * 3, [&] {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = +a[i];
+        }
+        sink = out[0][0];
+    });
+    Bench("unary -", "vec3", count * 3, [&] {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = -a[i];
+        }
+        sink = out[0][0];
+    });
+    Bench("dot *", "vec3", count * 3, [&] {
+        double sum = 0.;
+        for (size_t i = 0; i < count; ++i) {
+            sum += a[i] * b[i];
+        }
+        sink = sum;
+    });
+    Bench("dot *", "vector3", count * 3, [&] {
+        double sum = 0.;
+        for (size_t i = 0; i < count; ++i) {
+            sum += va[i] * vb[i];
+        }
+        sink = sum;
+    });
+    Bench("cross %", "vec3", count * 3, [&] {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = a[i] % b[i];
+        }
+        sink = out[0][0];
+    });
+    Bench("collinear ||", "vec3", count * 3, [&] {
+        size_t hits = 0;
+        for (size_t i = 0; i < count; ++i) {
+            hits += a[i] || b[i];
+        }
+        sink = hits;
+    });
+    Bench("collinear ||", "vector3", count * 3, [&] {
+        size_t hits = 0;
+        for (size_t i = 0; i < count; ++i) {
+            hits += va[i] || vb[i];
+        }
+        sink = hits;
+    });
+    Bench("codirect &&", "vec3", count * 3, [&] {
+        size_t hits = 0;
+        for (size_t i = 0; i < count; ++i) {
+            hits += a[i] && b[i];
+        }
+        sink = hits;
+    });
+}
+
+void BenchIO(size_t n) {
+    if (n > MAX_IO_SIZE) {
+        return;
+    }
+    std::vector<double> a(n), b;
+    std::generate(a.begin(), a.end(), RandomDouble);
+
+    std::ostringstream text_out, binary_out;
+    text_out << n << " ";
+    write_text(text_out, a);
+    write_binary(binary_out, a);
+    const std::string text = text_out.str();
+    const std::string binary = binary_out.str();
+
+    std::string buffer;
+    Bench("output <<", "stream", n, [&] {
+        std::ostringstream os;
+        os << a;
+        sink = os.tellp();
+    });
+    Bench("output <<", "to_chars", n, [&] {
+        std::ostringstream os;
+        write_text(os, a, buffer);
+        sink = os.tellp();
+    });
+    Bench("output <<", "binary", n, [&] {
+        std::ostringstream os;
+        write_binary(os, a);
+        sink = os.tellp();
+    });
+    Bench("input >>", "stream", n, [&] {
+        std::istringstream is(text);
+        is >> b;
+        sink = b[0];
+    });
+    Bench("input >>", "from_chars", n, [&] {
+        std::istringstream is(text);
+        read_text(is, b);
+        sink = b[0];
+    });
+    Bench("input >>", "binary", n, [&] {
+        std::istringstream is(binary);
+        read_binary(is, b);
+        sink = b[0];
+    });
+}
+
+void BenchFlags(size_t n) {
+    std::vector<int> a(n), b(n);
+    std::generate(a.begin(), a.end(), RandomFlag);
+    std::generate(b.begin(), b.end(), RandomFlag);
+    BitVector packed_a(a), packed_b(b);
+
+    Bench("bitwise |", "scalar", n, [&] { sink = (a | b)[0]; });
+    Bench("bitwise |", "packed", n, [&] { sink = (packed_a | packed_b)[0]; });
+    Bench("bitwise &", "scalar", n, [&] { sink = (a & b)[0]; });
+    Bench("bitwise &", "packed", n, [&] { sink = (packed_a & packed_b)[0]; });
+    Bench("popcount", "packed", n, [&] { sink = packed_a.count(); });
+}
+
+
+void ReportAccuracy(size_t n) {
+    std::vector<double> a(n), b(n);
+    std::generate(a.begin(), a.end(), RandomWideDouble);
+    std::generate(b.begin(), b.end(), RandomWideDouble);
+
+    long double reference = 0.;
+    long double magnitude = 0.;
+    for (size_t i = 0; i < n; ++i) {
+        reference += static_cast<long double>(a[i]) * b[i];
+        magnitude += std::fabs(static_cast<long double>(a[i]) * b[i]);
+    }
+
+    auto error = [&](double value) {
+        return static_cast<double>(std::fabs(value - reference) / magnitude);
+    };
+
+    // parallel_dot blocks the same way for any thread count, so one column
+    // covers every thread count.
+    std::printf("%11zu %16.3e %16.3e\n", n, error(a * b), error(parallel_dot(a, b)));
+}
+
+
+int main(int argc, char** argv) {
+    size_t max_size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+    std::vector<size_t> sizes{3};
+    for (size_t n = 10; n <= max_size; n *= 10) {
+        sizes.push_back(n);
+    }
+
+    std::printf("%-14s %-10s %11s %20s %22s\n", "operator", "variant", "size", "throughput", "latency");
+    for (size_t n : sizes) {
+        BenchDoubles(n);
+        BenchCross(n);
+        BenchFixed(n);
+        BenchIO(n);
+        BenchFlags(n);
+        std::printf("\n");
+    }
+
+    // Relative error |result - reference| / sum |a_i * b_i| against a
+    // long double accumulation.
+    std::printf("%11s %16s %16s\n", "size", "naive", "blocked");
+    for (size_t n : sizes) {
+        ReportAccuracy(n);
+    }
+}
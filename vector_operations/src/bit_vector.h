@@ -0,0 +1,144 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "vector_ops.h"
+
+namespace task {
+
+// Packed alternative to std::vector<int> masks used with operator| and
+// operator&: one bit per flag, processed 64 flags per word.
+class BitVector {
+ public:
+  BitVector() : size_(0) {}
+
+  explicit BitVector(size_t size, bool value = false)
+      : words((size + WORD_BITS - 1) / WORD_BITS, value ? ~uint64_t(0) : 0),
+        size_(size) {
+    clear_tail();
+  }
+
+  // Every nonzero element becomes a set bit.
+  explicit BitVector(const std::vector<int>& flags) : BitVector(flags.size()) {
+    for (size_t i = 0; i < size_; i++) {
+      if (flags[i] != 0) {
+        words[i / WORD_BITS] |= uint64_t(1) << (i % WORD_BITS);
+      }
+    }
+  }
+
+  std::vector<int> to_int_vector() const {
+    std::vector<int> result(size_);
+    for (size_t i = 0; i < size_; i++) {
+      result[i] = get(i) ? 1 : 0;
+    }
+    return result;
+  }
+
+  size_t size() const { return size_; }
+
+  bool get(size_t i) const {
+    return (words[i / WORD_BITS] >> (i % WORD_BITS)) & 1;
+  }
+
+  bool operator[](size_t i) const { return get(i); }
+
+  void set(size_t i, bool value = true) {
+    uint64_t mask = uint64_t(1) << (i % WORD_BITS);
+    if (value) {
+      words[i / WORD_BITS] |= mask;
+    } else {
+      words[i / WORD_BITS] &= ~mask;
+    }
+  }
+
+  size_t count() const {
+    size_t result = 0;
+    for (auto word : words) {
+      result += __builtin_popcountll(word);
+    }
+    return result;
+  }
+
+  bool any() const {
+    for (auto word : words) {
+      if (word != 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool none() const { return !any(); }
+
+  bool all() const { return count() == size_; }
+
+  BitVector& operator|=(const BitVector& other) {
+    return apply(other, [](uint64_t a, uint64_t b) { return a | b; });
+  }
+
+  BitVector& operator&=(const BitVector& other) {
+    return apply(other, [](uint64_t a, uint64_t b) { return a & b; });
+  }
+
+  BitVector& operator^=(const BitVector& other) {
+    return apply(other, [](uint64_t a, uint64_t b) { return a ^ b; });
+  }
+
+  BitVector operator~() const {
+    BitVector result(*this);
+    for (auto& word : result.words) {
+      word = ~word;
+    }
+    result.clear_tail();
+    return result;
+  }
+
+  bool operator==(const BitVector& other) const {
+    return size_ == other.size_ && words == other.words;
+  }
+  bool operator!=(const BitVector& other) const { return !(*this == other); }
+
+ private:
+  static constexpr size_t WORD_BITS = 64;
+
+  std::vector<uint64_t> words;
+  size_t size_;
+
+  template <typename F>
+  BitVector& apply(const BitVector& other, F f) {
+    if (size_ != other.size_) {
+      throw DifferentDimensionsException();
+    }
+
+    size_t n = words.size();
+    uint64_t* lhs = words.data();
+    const uint64_t* rhs = other.words.data();
+    for (size_t i = 0; i < n; i++) {
+      lhs[i] = f(lhs[i], rhs[i]);
+    }
+    return *this;
+  }
+
+  // Bits past size_ in the last word are kept zero so that count() and
+  // operator== never see them.
+  void clear_tail() {
+    if (size_ % WORD_BITS != 0) {
+      words.back() &= (uint64_t(1) << (size_ % WORD_BITS)) - 1;
+    }
+  }
+};
+
+inline BitVector operator|(BitVector lhs, const BitVector& rhs) {
+  return lhs |= rhs;
+}
+
+inline BitVector operator&(BitVector lhs, const BitVector& rhs) {
+  return lhs &= rhs;
+}
+
+inline BitVector operator^(BitVector lhs, const BitVector& rhs) {
+  return lhs ^= rhs;
+}
+
+}  // namespace task
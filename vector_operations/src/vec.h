@@ -0,0 +1,181 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "vector_ops.h"
+
+namespace task {
+
+// Fixed-dimension counterpart of the std::vector<double> operators from
+// vector_ops.h. Elements live inside the object, every operator is unrolled
+// over the index sequence and dimension mismatches fail at compile time.
+template <size_t N, typename T = double>
+class Vec {
+  static_assert(N > 0, "Vector dimension must be positive");
+  static_assert(std::is_arithmetic<T>::value,
+                "Vector elements must be arithmetic");
+
+ public:
+  using value_type = T;
+
+  Vec() : data{} {}
+
+  template <typename... Args,
+            typename = std::enable_if_t<sizeof...(Args) == N && N != 1>>
+  Vec(Args... args) : data{static_cast<T>(args)...} {}
+
+  explicit Vec(T value) { data.fill(value); }
+
+  explicit Vec(const std::vector<T>& v) {
+    if (v.size() != N) {
+      throw WrongDimensionsException();
+    }
+    for (size_t i = 0; i < N; i++) {
+      data[i] = v[i];
+    }
+  }
+
+  static constexpr size_t size() { return N; }
+
+  T& operator[](size_t i) { return data[i]; }
+  const T& operator[](size_t i) const { return data[i]; }
+
+  T* begin() { return data.data(); }
+  T* end() { return data.data() + N; }
+  const T* begin() const { return data.data(); }
+  const T* end() const { return data.data() + N; }
+
+  std::vector<T> to_vector() const {
+    return std::vector<T>(data.begin(), data.end());
+  }
+
+  bool operator==(const Vec& other) const { return data == other.data; }
+  bool operator!=(const Vec& other) const { return data != other.data; }
+
+ private:
+  std::array<T, N> data;
+};
+
+namespace detail {
+
+template <size_t N, typename T, typename F, size_t... I>
+Vec<N, T> apply(const Vec<N, T>& lhs, const Vec<N, T>& rhs, F f,
+                std::index_sequence<I...>) {
+  return Vec<N, T>(f(lhs[I], rhs[I])...);
+}
+
+template <size_t N, typename T, typename F, size_t... I>
+Vec<N, T> apply(const Vec<N, T>& v, F f, std::index_sequence<I...>) {
+  return Vec<N, T>(f(v[I])...);
+}
+
+template <size_t N, typename T, size_t... I>
+T dot(const Vec<N, T>& lhs, const Vec<N, T>& rhs, std::index_sequence<I...>) {
+  return ((lhs[I] * rhs[I]) + ...);
+}
+
+template <size_t N, typename T, size_t... I>
+bool is_zero(const Vec<N, T>& v, std::index_sequence<I...>) {
+  return ((v[I] == 0) && ...);
+}
+
+// lhs and rhs are collinear iff every minor lhs[i] * rhs[k] - lhs[k] * rhs[i]
+// vanishes for some k with lhs[k] != 0.
+template <size_t N, typename T, size_t... I>
+bool minors_vanish(const Vec<N, T>& lhs, const Vec<N, T>& rhs, size_t k,
+                   std::index_sequence<I...>) {
+  auto vanishes = [&](size_t i) {
+    double a = static_cast<double>(lhs[i]) * rhs[k];
+    double b = static_cast<double>(lhs[k]) * rhs[i];
+    return std::fabs(a - b) <= 1e-12 * (std::fabs(a) + std::fabs(b));
+  };
+  return (vanishes(I) && ...);
+}
+
+}  // namespace detail
+
+template <size_t N, size_t M, typename T>
+Vec<N, T> operator+(const Vec<N, T>& lhs, const Vec<M, T>& rhs) {
+  static_assert(N == M, "Vectors have different dimension");
+  return detail::apply(lhs, rhs, [](T a, T b) { return a + b; },
+                       std::make_index_sequence<N>());
+}
+
+template <size_t N, typename T>
+Vec<N, T> operator+(const Vec<N, T>& v) {
+  return v;
+}
+
+template <size_t N, size_t M, typename T>
+Vec<N, T> operator-(const Vec<N, T>& lhs, const Vec<M, T>& rhs) {
+  static_assert(N == M, "Vectors have different dimension");
+  return detail::apply(lhs, rhs, [](T a, T b) { return a - b; },
+                       std::make_index_sequence<N>());
+}
+
+template <size_t N, typename T>
+Vec<N, T> operator-(const Vec<N, T>& v) {
+  return detail::apply(v, [](T a) { return -a; },
+                       std::make_index_sequence<N>());
+}
+
+template <size_t N, size_t M, typename T>
+T operator*(const Vec<N, T>& lhs, const Vec<M, T>& rhs) {
+  static_assert(N == M, "Vectors have different dimension");
+  return detail::dot(lhs, rhs, std::make_index_sequence<N>());
+}
+
+template <size_t N, size_t M, typename T>
+Vec<N, T> operator%(const Vec<N, T>& lhs, const Vec<M, T>& rhs) {
+  static_assert(N == M, "Vectors have different dimension");
+  static_assert(N == 3, "Vectors have wrong dimension");
+  return Vec<N, T>(lhs[1] * rhs[2] - lhs[2] * rhs[1],
+                   lhs[2] * rhs[0] - lhs[0] * rhs[2],
+                   lhs[0] * rhs[1] - lhs[1] * rhs[0]);
+}
+
+template <size_t N, size_t M, typename T>
+bool operator||(const Vec<N, T>& lhs, const Vec<M, T>& rhs) {
+  static_assert(N == M, "Vectors have different dimension");
+  auto indices = std::make_index_sequence<N>();
+
+  // A zero vector is collinear to any other vector.
+  if (detail::is_zero(lhs, indices) || detail::is_zero(rhs, indices)) {
+    return true;
+  }
+
+  size_t k = 0;
+  while (lhs[k] == 0) {
+    k++;
+  }
+  return detail::minors_vanish(lhs, rhs, k, indices);
+}
+
+template <size_t N, size_t M, typename T>
+bool operator&&(const Vec<N, T>& lhs, const Vec<M, T>& rhs) {
+  static_assert(N == M, "Vectors have different dimension");
+  auto indices = std::make_index_sequence<N>();
+
+  // A zero vector is codirectional to any other vector.
+  if (detail::is_zero(lhs, indices) || detail::is_zero(rhs, indices)) {
+    return true;
+  }
+
+  return (lhs || rhs) && (lhs * rhs > 0);
+}
+
+template <size_t N, typename T>
+std::ostream& operator<<(std::ostream& os, const Vec<N, T>& v) {
+  for (const auto& iter : v) {
+    os << iter << " ";
+  }
+  os << "\n";
+
+  return os;
+}
+
+}  // namespace task
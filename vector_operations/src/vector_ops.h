@@ -1,6 +1,13 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
 #include <exception>
 #include <iostream>
+#include <string>
+#include <thread>
 #include <vector>
 
 namespace task {
@@ -90,6 +97,146 @@ double operator*(const std::vector<double>& lhs,
   return result;
 }
 
+// Parallel reductions for long vectors. The range is cut into fixed-size
+// blocks independent of the thread count, every block is summed with Kahan
+// compensation and the block sums are combined pairwise in index order, so
+// the result does not depend on how many threads took part.
+namespace detail {
+
+const size_t PARALLEL_BLOCK_SIZE = 1 << 14;
+const size_t PARALLEL_MIN_SIZE = 1 << 18;
+
+inline size_t default_thread_count() {
+  size_t n = std::thread::hardware_concurrency();
+  return n == 0 ? 1 : n;
+}
+
+// Calls f(first_block, last_block) for contiguous block ranges, one per
+// thread. The calling thread takes the first range itself. If starting a
+// thread or the calling thread's range throws, the threads already running
+// are joined before the exception propagates.
+template <typename F>
+void run_parallel(size_t n_blocks, size_t num_threads, F f) {
+  if (num_threads > n_blocks) {
+    num_threads = n_blocks;
+  }
+  if (num_threads <= 1) {
+    f(0, n_blocks);
+    return;
+  }
+
+  std::vector<std::thread> workers;
+  workers.reserve(num_threads - 1);
+  size_t per_thread = n_blocks / num_threads;
+  size_t rest = n_blocks % num_threads;
+  size_t first = per_thread + (rest > 0 ? 1 : 0);
+  try {
+    for (size_t t = 1; t < num_threads; t++) {
+      size_t count = per_thread + (t < rest ? 1 : 0);
+      workers.emplace_back(f, first, first + count);
+      first += count;
+    }
+    f(0, per_thread + (rest > 0 ? 1 : 0));
+  } catch (...) {
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    throw;
+  }
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+inline double kahan_dot(const double* lhs, const double* rhs, size_t n) {
+  double sum = 0.0;
+  double compensation = 0.0;
+  for (size_t i = 0; i < n; i++) {
+    double y = lhs[i] * rhs[i] - compensation;
+    double t = sum + y;
+    compensation = (t - sum) - y;
+    sum = t;
+  }
+  return sum;
+}
+
+inline double pairwise_sum(const double* values, size_t n) {
+  if (n == 0) {
+    return 0.0;
+  }
+  if (n == 1) {
+    return values[0];
+  }
+  size_t half = n / 2;
+  return pairwise_sum(values, half) + pairwise_sum(values + half, n - half);
+}
+
+}  // namespace detail
+
+inline double parallel_dot(const std::vector<double>& lhs,
+                           const std::vector<double>& rhs,
+                           size_t num_threads = detail::default_thread_count()) {
+  size_t n1 = lhs.size();
+  size_t n2 = rhs.size();
+
+  if (n1 != n2) {
+    throw DifferentDimensionsException();
+  }
+
+  size_t block = detail::PARALLEL_BLOCK_SIZE;
+  size_t n_blocks = (n1 + block - 1) / block;
+  std::vector<double> partial(n_blocks);
+
+  if (n1 < detail::PARALLEL_MIN_SIZE) {
+    num_threads = 1;
+  }
+
+  detail::run_parallel(n_blocks, num_threads, [&](size_t first, size_t last) {
+    for (size_t b = first; b < last; b++) {
+      size_t begin = b * block;
+      size_t len = std::min(block, n1 - begin);
+      partial[b] = detail::kahan_dot(lhs.data() + begin, rhs.data() + begin,
+                                     len);
+    }
+  });
+
+  return detail::pairwise_sum(partial.data(), n_blocks);
+}
+
+// Each thread polls a shared flag between blocks and stops as soon as any
+// thread has seen a nonzero element.
+template <typename T>
+bool parallel_check_if_zero(
+    const std::vector<T>& v,
+    size_t num_threads = detail::default_thread_count()) {
+  size_t n = v.size();
+  if (n < detail::PARALLEL_MIN_SIZE) {
+    return check_if_zero(v);
+  }
+
+  size_t block = detail::PARALLEL_BLOCK_SIZE;
+  size_t n_blocks = (n + block - 1) / block;
+  std::atomic<bool> found_nonzero(false);
+
+  detail::run_parallel(n_blocks, num_threads, [&](size_t first, size_t last) {
+    for (size_t b = first; b < last; b++) {
+      if (found_nonzero.load(std::memory_order_relaxed)) {
+        return;
+      }
+      size_t end = std::min(n, (b + 1) * block);
+      for (size_t i = b * block; i < end; i++) {
+        if (v[i] != 0) {
+          found_nonzero.store(true, std::memory_order_relaxed);
+          return;
+        }
+      }
+    }
+  });
+
+  return !found_nonzero.load();
+}
+
 std::vector<double> operator%(const std::vector<double>& lhs,
                               const std::vector<double>& rhs) {
   size_t n1 = lhs.size();
@@ -111,6 +258,76 @@ std::vector<double> operator%(const std::vector<double>& lhs,
   return result;
 }
 
+// Batched cross product over structure-of-arrays input: the i-th vectors are
+// (lx[i], ly[i], lz[i]) and (rx[i], ry[i], rz[i]), the result goes to
+// (out_x[i], out_y[i], out_z[i]). Output buffers are provided by the caller and
+// must not overlap the input or each other; __restrict states that, so the
+// loop needs no runtime alias checks. At -O2 GCC only vectorizes loops whose
+// trip count is a known multiple of the vector width, hence the fixed blocks
+// of CROSS_BLOCK elements followed by a scalar tail.
+inline void cross_batch(const double* __restrict lx,
+                        const double* __restrict ly,
+                        const double* __restrict lz,
+                        const double* __restrict rx,
+                        const double* __restrict ry,
+                        const double* __restrict rz, double* __restrict out_x,
+                        double* __restrict out_y, double* __restrict out_z,
+                        size_t n) {
+  const size_t CROSS_BLOCK = 4;
+  size_t i = 0;
+  for (; i + CROSS_BLOCK <= n; i += CROSS_BLOCK) {
+    for (size_t j = i; j < i + CROSS_BLOCK; j++) {
+      out_x[j] = ly[j] * rz[j] - lz[j] * ry[j];
+      out_y[j] = lz[j] * rx[j] - lx[j] * rz[j];
+      out_z[j] = lx[j] * ry[j] - ly[j] * rx[j];
+    }
+  }
+  for (; i < n; i++) {
+    out_x[i] = ly[i] * rz[i] - lz[i] * ry[i];
+    out_y[i] = lz[i] * rx[i] - lx[i] * rz[i];
+    out_z[i] = lx[i] * ry[i] - ly[i] * rx[i];
+  }
+}
+
+// Unlike the pointer overload, any output may be the same vector as an input
+// or another output: the result is then computed into scratch vectors and
+// moved into place, so the __restrict promise above still holds.
+inline void cross_batch(const std::vector<double>& lx,
+                        const std::vector<double>& ly,
+                        const std::vector<double>& lz,
+                        const std::vector<double>& rx,
+                        const std::vector<double>& ry,
+                        const std::vector<double>& rz,
+                        std::vector<double>& out_x, std::vector<double>& out_y,
+                        std::vector<double>& out_z) {
+  size_t n = lx.size();
+
+  if (ly.size() != n || lz.size() != n || rx.size() != n || ry.size() != n ||
+      rz.size() != n) {
+    throw DifferentDimensionsException();
+  }
+
+  auto is_input = [&](const std::vector<double>& out) {
+    return &out == &lx || &out == &ly || &out == &lz || &out == &rx ||
+           &out == &ry || &out == &rz;
+  };
+  if (is_input(out_x) || is_input(out_y) || is_input(out_z) ||
+      &out_x == &out_y || &out_x == &out_z || &out_y == &out_z) {
+    std::vector<double> x, y, z;
+    cross_batch(lx, ly, lz, rx, ry, rz, x, y, z);
+    out_x = std::move(x);
+    out_y = std::move(y);
+    out_z = std::move(z);
+    return;
+  }
+
+  out_x.resize(n);
+  out_y.resize(n);
+  out_z.resize(n);
+  cross_batch(lx.data(), ly.data(), lz.data(), rx.data(), ry.data(), rz.data(),
+              out_x.data(), out_y.data(), out_z.data(), n);
+}
+
 bool are_equal(double a, double b) {
   double diff = a - b;
   return (diff < 1e-12) && (diff > -1e-12);
@@ -125,8 +342,8 @@ bool operator||(const std::vector<double>& lhs,
     throw DifferentDimensionsException();
   }
 
-  //   ,        
-  // .
+  // ����� ���� ��������, ���� �� ������� ����� �������� ������� ����� �������
+  // �������������.
   if (check_if_zero(lhs) || check_if_zero(rhs)) {
     return true;
   }
@@ -134,7 +351,7 @@ bool operator||(const std::vector<double>& lhs,
   int k = 0;
   double coef;
 
-  //      
+  // ������ ��������� ���������� ��� ���������� ������������
   while (k < n1) {
     if (lhs[k] == 0 && rhs[k] == 0) {
       k++;
@@ -163,7 +380,7 @@ bool operator&&(const std::vector<double>& lhs,
   size_t n1 = lhs.size();
   size_t n2 = rhs.size();
 
-  //      .
+  //������� ������ ������� ������� �������������� ������ �������.
   if (check_if_zero(lhs) || check_if_zero(rhs)) {
     return true;
   }
@@ -193,6 +410,175 @@ std::ostream& operator<<(std::ostream& os, const std::vector<double>& v) {
   return os;
 }
 
+// Binary format: element count as uint64_t followed by the raw doubles, both
+// in native byte order.
+inline void write_binary(std::ostream& os, const std::vector<double>& v) {
+  uint64_t sz = v.size();
+  os.write(reinterpret_cast<const char*>(&sz), sizeof(sz));
+  os.write(reinterpret_cast<const char*>(v.data()),
+           static_cast<std::streamsize>(sz * sizeof(double)));
+}
+
+namespace detail {
+
+// Elements a reader allocates ahead of the data that fills them.
+const uint64_t READ_PIECE = 1 << 16;
+
+}  // namespace detail
+
+// The count in the header is not trusted: v grows a piece at a time as the
+// data actually arrives, so a corrupt or hostile header fails the stream
+// instead of forcing a huge allocation. On failure v holds the elements read.
+inline void read_binary(std::istream& is, std::vector<double>& v) {
+  uint64_t sz = 0;
+  if (!is.read(reinterpret_cast<char*>(&sz), sizeof(sz))) {
+    return;
+  }
+
+  v.clear();
+  while (v.size() < sz) {
+    size_t done = v.size();
+    size_t piece =
+        static_cast<size_t>(std::min(sz - done, detail::READ_PIECE));
+    v.resize(done + piece);
+    if (!is.read(reinterpret_cast<char*>(v.data() + done),
+                 static_cast<std::streamsize>(piece * sizeof(double)))) {
+      v.resize(done + static_cast<size_t>(is.gcount()) / sizeof(double));
+      return;
+    }
+  }
+}
+
+namespace detail {
+
+// Longest text produced by std::to_chars for a double in shortest form.
+const size_t MAX_DOUBLE_CHARS = 32;
+
+// Longest token the readers accept. The exact decimal expansion of any
+// double, the smallest subnormal included, is shorter than this.
+const size_t MAX_TOKEN_CHARS = 2048;
+
+// Size of the buffer the text writer fills before each write to the stream.
+const size_t WRITE_PIECE = 1 << 16;
+
+// std::isspace is undefined for negative values other than EOF, which is
+// what a plain char above 0x7f becomes.
+inline bool is_space(char c) {
+  return std::isspace(static_cast<unsigned char>(c));
+}
+
+// Reads one whitespace-separated token straight from the stream buffer,
+// leaving the stream positioned right after it. A token longer than capacity
+// continues in overflow, which then holds all of it. Reading stops after
+// MAX_TOKEN_CHARS + 1 characters, so a longer token is never buffered whole
+// and is reported by a length over MAX_TOKEN_CHARS.
+inline size_t read_token(std::streambuf* buf, char* token, size_t capacity,
+                         std::string& overflow) {
+  using traits = std::char_traits<char>;
+  auto c = buf->sgetc();
+  while (c != traits::eof() && is_space(traits::to_char_type(c))) {
+    c = buf->snextc();
+  }
+
+  size_t len = 0;
+  while (c != traits::eof() && !is_space(traits::to_char_type(c))) {
+    if (len == MAX_TOKEN_CHARS) {
+      return len + 1;
+    }
+    if (len < capacity) {
+      token[len] = traits::to_char_type(c);
+    } else {
+      if (len == capacity) {
+        overflow.assign(token, capacity);
+      }
+      overflow.push_back(traits::to_char_type(c));
+    }
+    len++;
+    c = buf->snextc();
+  }
+  return len;
+}
+
+template <typename T>
+bool parse_token(std::streambuf* buf, T& value) {
+  char token[MAX_DOUBLE_CHARS * 2];
+  std::string overflow;
+  size_t len = read_token(buf, token, sizeof(token), overflow);
+  if (len == 0 || len > MAX_TOKEN_CHARS) {
+    return false;
+  }
+  const char* text = len > sizeof(token) ? overflow.data() : token;
+  auto result = std::from_chars(text, text + len, value);
+  return result.ec == std::errc() && result.ptr == text + len;
+}
+
+}  // namespace detail
+
+// Same format as operator>>, but parsed with std::from_chars instead of the
+// locale-aware stream extraction. As in read_binary, the count is not
+// trusted: v grows as elements are parsed. On failure v holds the elements
+// read.
+inline std::istream& read_text(std::istream& is, std::vector<double>& v) {
+  std::istream::sentry sentry(is);
+  if (!sentry) {
+    return is;
+  }
+
+  std::streambuf* buf = is.rdbuf();
+  size_t sz;
+  if (!detail::parse_token(buf, sz)) {
+    is.setstate(std::ios::failbit);
+    return is;
+  }
+
+  v.clear();
+  v.reserve(static_cast<size_t>(std::min<uint64_t>(sz, detail::READ_PIECE)));
+  for (size_t i = 0; i < sz; i++) {
+    double value;
+    if (!detail::parse_token(buf, value)) {
+      is.setstate(std::ios::failbit);
+      return is;
+    }
+    v.push_back(value);
+  }
+
+  return is;
+}
+
+// Same format as operator<<, formatted with std::to_chars into buffer, which
+// is reused between calls to avoid reallocation. The buffer holds at most
+// WRITE_PIECE bytes and is written out each time it fills.
+inline std::ostream& write_text(std::ostream& os, const std::vector<double>& v,
+                                std::string& buffer) {
+  if (buffer.size() < detail::WRITE_PIECE) {
+    buffer.resize(detail::WRITE_PIECE);
+  }
+  char* first = &buffer[0];
+  char* last = first + buffer.size();
+  char* out = first;
+
+  for (const auto& iter : v) {
+    // Room for this element, its separator and the final newline.
+    if (static_cast<size_t>(last - out) < detail::MAX_DOUBLE_CHARS + 2) {
+      if (!os.write(first, out - first)) {
+        return os;
+      }
+      out = first;
+    }
+    out = std::to_chars(out, last, iter).ptr;
+    *out++ = ' ';
+  }
+  *out++ = '\n';
+
+  return os.write(first, out - first);
+}
+
+inline std::ostream& write_text(std::ostream& os,
+                                const std::vector<double>& v) {
+  std::string buffer;
+  return write_text(os, v, buffer);
+}
+
 void reverse(std::vector<double>& v) {
   size_t n = v.size();
   for (int i = 0; i < n / 2; i++) {
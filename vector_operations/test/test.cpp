@@ -6,7 +6,11 @@
 #include <valarray>
 #include <sstream>
 #include <cmath>
+#include <atomic>
+#include <stdexcept>
 #include "src/vector_ops.h"
+#include "src/vec.h"
+#include "src/bit_vector.h"
 
 
 using namespace task;
@@ -178,6 +182,30 @@ int main() {
         ASSERT_TRUE_MSG(fabs(cross * cross - vec[2] * vec[2] * vec2[0] * vec2[0]) < EPS, "Cross product")
     }
 
+    REPEAT(10)
+    {
+        size_t n = RandomUInt(1, 1000);
+        std::vector<double> lx, ly, lz, rx, ry, rz, ox, oy, oz;
+        RandomFillDouble(lx, n);
+        RandomFillDouble(ly, n);
+        RandomFillDouble(lz, n);
+        RandomFillDouble(rx, n);
+        RandomFillDouble(ry, n);
+        RandomFillDouble(rz, n);
+
+        cross_batch(lx, ly, lz, rx, ry, rz, ox, oy, oz);
+
+        for (size_t i = 0; i < n; ++i) {
+            auto cross = std::vector<double>{lx[i], ly[i], lz[i]} % std::vector<double>{rx[i], ry[i], rz[i]};
+            ASSERT_TRUE_MSG(fabs(cross[0] - ox[i]) < EPS && fabs(cross[1] - oy[i]) < EPS &&
+                            fabs(cross[2] - oz[i]) < EPS, "Batched cross product")
+        }
+
+        // The result overwrites the left vectors.
+        cross_batch(lx, ly, lz, rx, ry, rz, lx, ly, lz);
+        ASSERT_TRUE_MSG(lx == ox && ly == oy && lz == oz, "Batched cross product in place")
+    }
+
     REPEAT(100)
     {
         std::vector<double> vec, vec2;
@@ -235,4 +263,178 @@ int main() {
         ASSERT_EQUAL_MSG(vec, vec2, "reverse")
     }
 
+    REPEAT(100)
+    {
+        std::vector<int> vec, vec2;
+        size_t n = RandomUInt(0, 1000);
+        RandomFill(vec, n, 1);
+        RandomFill(vec2, n, 1);
+        BitVector a(vec), b(vec2);
+
+        ASSERT_TRUE_MSG((a | b).to_int_vector() == (vec | vec2), "Packed bitwise OR")
+        ASSERT_TRUE_MSG((a & b).to_int_vector() == (vec & vec2), "Packed bitwise AND")
+
+        std::vector<int> x, inverted;
+        for (size_t i = 0; i < n; ++i) {
+            x.push_back(vec[i] ^ vec2[i]);
+            inverted.push_back(1 - vec[i]);
+        }
+        ASSERT_TRUE_MSG((a ^ b).to_int_vector() == x, "Packed bitwise XOR")
+        ASSERT_TRUE_MSG((~a).to_int_vector() == inverted, "Packed bitwise NOT")
+
+        size_t ones = std::count(vec.begin(), vec.end(), 1);
+        ASSERT_TRUE_MSG(a.count() == ones && (~a).count() == n - ones, "Packed popcount")
+        ASSERT_TRUE_MSG(a.any() == (ones > 0) && a.all() == (ones == n), "Packed any/all")
+        ASSERT_TRUE_MSG((a | ~a).all() && (a & ~a).none(), "Packed any/all")
+    }
+
+    REPEAT(100)
+    {
+        std::vector<double> vec, vec2;
+        RandomFillDouble(vec, 3);
+        RandomFillDouble(vec2, 3);
+        Vec<3> a(vec), b(vec2);
+
+        ASSERT_TRUE_MSG((a + b).to_vector() == vec + vec2, "Fixed binary +")
+        ASSERT_TRUE_MSG((a - b).to_vector() == vec - vec2, "Fixed binary -")
+        ASSERT_TRUE_MSG((+a).to_vector() == +vec, "Fixed unary +")
+        ASSERT_TRUE_MSG((-a).to_vector() == -vec, "Fixed unary -")
+        ASSERT_TRUE_MSG(fabs(a * b - vec * vec2) < EPS, "Fixed dot product")
+
+        auto cross = a % b;
+        auto cross2 = vec % vec2;
+        for (size_t i = 0; i < 3; ++i) {
+            ASSERT_TRUE_MSG(fabs(cross[i] - cross2[i]) < EPS, "Fixed cross product")
+        }
+
+        auto mult = RandomDouble();
+        Vec<3> c = b;
+        for (auto& item : c) {
+            item *= mult;
+        }
+
+        ASSERT_TRUE_MSG(b || c, "Fixed collinearity operator")
+        ASSERT_TRUE_MSG((b && c) == (mult > 0), "Fixed codirectionality operator")
+
+        c[RandomUInt(2)] *= 3.;
+        ASSERT_TRUE_MSG(!(b || c) && !(b && c), "Fixed collinearity operator")
+        ASSERT_TRUE_MSG((Vec<3>() || b) && (b && Vec<3>()), "Fixed zero vector")
+    }
+
+    REPEAT(10)
+    {
+        std::vector<double> vec, vec2, vec3;
+        RandomFillDouble(vec, RandomUInt(0, 1000));
+
+        std::stringstream binary;
+        write_binary(binary, vec);
+        write_binary(binary, vec);
+        read_binary(binary, vec2);
+        read_binary(binary, vec3);
+
+        ASSERT_TRUE_MSG(binary && vec == vec2 && vec == vec3, "Binary input/output")
+
+        std::string buffer;
+        std::stringstream text;
+        text << vec.size() << '\n';
+        write_text(text, vec, buffer);
+        text << vec.size() << '\n';
+        write_text(text, vec, buffer);
+
+        ASSERT_TRUE_MSG(*(text.str().end() - 1) == '\n', "Fast text output")
+
+        vec2.clear();
+        vec3.clear();
+        read_text(text, vec2);
+        read_text(text, vec3);
+
+        ASSERT_TRUE_MSG(text && vec == vec2 && vec == vec3, "Fast text input/output")
+
+        text.str("2 1.5 oops");
+        text.clear();
+        read_text(text, vec2);
+
+        ASSERT_TRUE_MSG(text.fail(), "Fast text input")
+
+        std::string long_token = "0." + std::string(100, '0') + "15";
+        std::string long_text = "2 " + long_token + " -" + long_token;
+        std::stringstream fast_long(long_text), slow_long(long_text);
+        read_text(fast_long, vec2);
+        slow_long >> vec3;
+
+        ASSERT_TRUE_MSG(fast_long && vec2.size() == 2 && vec2 == vec3, "Fast text input of long tokens")
+
+        std::stringstream corrupt;
+        uint64_t huge_size = uint64_t(1) << 60;
+        corrupt.write(reinterpret_cast<const char*>(&huge_size), sizeof(huge_size));
+        corrupt.write(reinterpret_cast<const char*>(vec.data()),
+                      static_cast<std::streamsize>(vec.size() * sizeof(double)));
+        read_binary(corrupt, vec2);
+
+        ASSERT_TRUE_MSG(corrupt.fail() && vec2 == vec, "Binary input with a corrupt size")
+
+        std::stringstream hostile("1000000000000 1.5");
+        read_text(hostile, vec2);
+
+        ASSERT_TRUE_MSG(hostile.fail() && vec2 == std::vector<double>{1.5}, "Fast text input with a corrupt size")
+
+        std::stringstream endless("2 1.5 " + std::string(1 << 20, '1'));
+        read_text(endless, vec2);
+
+        ASSERT_TRUE_MSG(endless.fail() && vec2 == std::vector<double>{1.5}, "Fast text input of an overlong token")
+    }
+
+    {
+        // Spans several fills of the output buffer.
+        std::vector<double> vec, vec2;
+        RandomFillDouble(vec, RandomUInt(10000, 20000));
+
+        std::string buffer;
+        std::stringstream text;
+        text << vec.size() << '\n';
+        write_text(text, vec, buffer);
+        read_text(text, vec2);
+
+        ASSERT_TRUE_MSG(text && vec == vec2, "Fast text input/output of a long vector")
+        ASSERT_TRUE_MSG(buffer.size() < vec.size() * 8, "Fast text output buffer is bounded")
+    }
+
+    REPEAT(3)
+    {
+        std::vector<double> vec, vec2;
+        RandomFillDouble(vec, RandomUInt(1 << 18, 1 << 20));
+        RandomFillDouble(vec2, vec.size());
+
+        double res = parallel_dot(vec, vec2);
+        double res2 = (std::valarray<double>(vec.data(), vec.size()) *
+                       std::valarray<double>(vec2.data(), vec2.size())).sum();
+
+        ASSERT_TRUE_MSG(fabs(res - res2) < 1e-6 * vec.size(), "Parallel dot product")
+        ASSERT_TRUE_MSG(res == parallel_dot(vec, vec2, 1) && res == parallel_dot(vec, vec2, 7),
+                        "Parallel dot product determinism")
+
+        std::vector<double> zeros(vec.size(), 0.);
+        ASSERT_TRUE_MSG(parallel_check_if_zero(zeros), "Parallel zero check")
+
+        zeros[RandomUInt(zeros.size() - 1)] = 1.;
+        ASSERT_TRUE_MSG(!parallel_check_if_zero(zeros), "Parallel zero check")
+    }
+
+    {
+        // The calling thread fails its range while the workers still run.
+        std::atomic<size_t> done(0);
+        bool thrown = false;
+        try {
+            detail::run_parallel(16, 4, [&done](size_t first, size_t last) {
+                if (first == 0) {
+                    throw std::runtime_error("block failed");
+                }
+                done += last - first;
+            });
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        ASSERT_TRUE_MSG(thrown && done == 12, "Parallel run joins its threads on an exception")
+    }
+
 }